@@ -0,0 +1,247 @@
+/*
+// Copyright (c) 2026 Ben Ashbaugh
+//
+// SPDX-License-Identifier: MIT
+*/
+
+#pragma once
+#include <sycl/sycl.hpp>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace chrometrace
+{
+
+// Records host and device activity for SYCL queues and writes it as a
+// Chrome trace-event JSON file, which can be viewed in Perfetto or in
+// chrome://tracing.
+//
+// Host activity is the time spent in submit, memcpy, parallel_for, and wait
+// calls on the host.  Device activity is the execution time of each
+// command from its profiling information, so queues must be created with
+// the enable_profiling property, see queue_properties.  Device timestamps
+// are placed on the host timeline using the offset between the host time
+// and the device command_submit time of the first traced command on each
+// queue, since queues on different devices have unrelated device clocks.
+//
+// A tracer with an empty file name is disabled and records nothing.
+class Tracer {
+public:
+    explicit Tracer(const std::string& _fileName = "") :
+        fileName(_fileName), start(clock::now()) {}
+
+    bool enabled() const { return !fileName.empty(); }
+
+    // Records a command submitted to the queue with the given index.
+    void addCommand(const std::string& name, int queue,
+        uint64_t hostBegin, uint64_t hostEnd, const sycl::event& event) {
+        std::lock_guard<std::mutex> lock(mutex);
+        records.push_back(Record{ name, queue, hostBegin, hostEnd, true, event });
+    }
+
+    // Records host activity that has no device command, such as a wait.
+    void addHost(const std::string& name, int queue, uint64_t hostBegin, uint64_t hostEnd) {
+        std::lock_guard<std::mutex> lock(mutex);
+        records.push_back(Record{ name, queue, hostBegin, hostEnd, false, sycl::event() });
+    }
+
+    int addQueue(const std::string& name) {
+        std::lock_guard<std::mutex> lock(mutex);
+        queueNames.push_back(name);
+        return static_cast<int>(queueNames.size() - 1);
+    }
+
+    // Nanoseconds since the tracer was created.
+    uint64_t now() const {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(clock::now() - start).count();
+    }
+
+    // Writes the trace file.  All traced commands must be complete.
+    bool write() {
+        if (!enabled()) {
+            return true;
+        }
+
+        std::lock_guard<std::mutex> lock(mutex);
+        std::ofstream os(fileName);
+        if (!os.good()) {
+            return false;
+        }
+
+        // The host is thread 0, and each queue is thread 1 + its index.
+        os << "{\"traceEvents\":[\n";
+        os << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":0,\"args\":{\"name\":\"Host\"}}";
+        for (size_t q = 0; q < queueNames.size(); q++) {
+            os << ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":" << q + 1
+               << ",\"args\":{\"name\":\"" << escape(queueNames[q]) << "\"}}";
+        }
+
+        std::vector<std::optional<int64_t>> offsets(queueNames.size());
+        for (auto& r : records) {
+            writeEvent(os, r.name, "host", 0, r.hostBegin, r.hostEnd);
+            if (!r.hasEvent) {
+                continue;
+            }
+            try {
+                const uint64_t submit = r.event.get_profiling_info<sycl::info::event_profiling::command_submit>();
+                const uint64_t begin = r.event.get_profiling_info<sycl::info::event_profiling::command_start>();
+                const uint64_t end = r.event.get_profiling_info<sycl::info::event_profiling::command_end>();
+                auto& offset = offsets[r.queue];
+                if (!offset) {
+                    offset = static_cast<int64_t>(r.hostBegin) - static_cast<int64_t>(submit);
+                }
+                writeEvent(os, r.name, "device", r.queue + 1, begin + *offset, end + *offset);
+            } catch (const sycl::exception&) {
+                // The queue does not support profiling.
+            }
+        }
+        os << "\n]}\n";
+
+        return os.good();
+    }
+
+    const std::string& file() const { return fileName; }
+
+private:
+    using clock = std::chrono::steady_clock;
+
+    struct Record {
+        std::string name;
+        int queue;
+        uint64_t hostBegin;
+        uint64_t hostEnd;
+        bool hasEvent;
+        sycl::event event;
+    };
+
+    static std::string escape(const std::string& s) {
+        std::string ret;
+        for (char c : s) {
+            if (c == '"' || c == '\\') {
+                ret += '\\';
+            }
+            ret += c;
+        }
+        return ret;
+    }
+
+    static void writeEvent(std::ofstream& os, const std::string& name, const char* cat,
+        int tid, int64_t begin, int64_t end) {
+        char ts[64];
+        snprintf(ts, sizeof(ts), "%.3f,\"dur\":%.3f", begin / 1000.0, (end - begin) / 1000.0);
+        os << ",\n{\"name\":\"" << escape(name) << "\",\"cat\":\"" << cat
+           << "\",\"ph\":\"X\",\"pid\":0,\"tid\":" << tid << ",\"ts\":" << ts << "}";
+    }
+
+    std::string fileName;
+    clock::time_point start;
+    std::mutex mutex;
+    std::vector<std::string> queueNames;
+    std::vector<Record> records;
+};
+
+// Returns the properties for an in-order queue, with profiling enabled if
+// the tracer is enabled.
+inline sycl::property_list queue_properties(const Tracer& tracer)
+{
+    if (tracer.enabled()) {
+        return sycl::property_list{
+            sycl::property::queue::in_order(),
+            sycl::property::queue::enable_profiling() };
+    }
+    return sycl::property_list{ sycl::property::queue::in_order() };
+}
+
+// Wraps a sycl::queue, recording submit, memcpy, memset, parallel_for, and
+// wait calls.  If the tracer is disabled, calls are passed through.  Use
+// label to name the next recorded command.
+class Queue {
+public:
+    Queue(sycl::queue& _queue, Tracer& _tracer, const std::string& name = "Queue") :
+        queue(_queue), tracer(_tracer), index(_tracer.enabled() ? _tracer.addQueue(name) : 0) {}
+
+    Queue& label(const std::string& name) {
+        nextLabel = name;
+        return *this;
+    }
+
+    template <typename T>
+    sycl::event submit(T&& cgf) {
+        return record("submit", [&]() { return queue.submit(std::forward<T>(cgf)); });
+    }
+
+    template <typename... Ts>
+    sycl::event memcpy(Ts&&... args) {
+        return record("memcpy", [&]() { return queue.memcpy(std::forward<Ts>(args)...); });
+    }
+
+    template <typename... Ts>
+    sycl::event memset(Ts&&... args) {
+        return record("memset", [&]() { return queue.memset(std::forward<Ts>(args)...); });
+    }
+
+    // Like sycl::queue, these overloads allow braced ranges such as
+    // parallel_for({gwy, gwx}, kernel).
+    template <typename K>
+    sycl::event parallel_for(sycl::range<1> r, K&& k) {
+        return record("parallel_for", [&]() { return queue.parallel_for(r, std::forward<K>(k)); });
+    }
+
+    template <typename K>
+    sycl::event parallel_for(sycl::range<2> r, K&& k) {
+        return record("parallel_for", [&]() { return queue.parallel_for(r, std::forward<K>(k)); });
+    }
+
+    template <typename K>
+    sycl::event parallel_for(sycl::range<3> r, K&& k) {
+        return record("parallel_for", [&]() { return queue.parallel_for(r, std::forward<K>(k)); });
+    }
+
+    template <typename... Ts>
+    sycl::event parallel_for(Ts&&... args) {
+        return record("parallel_for", [&]() { return queue.parallel_for(std::forward<Ts>(args)...); });
+    }
+
+    void wait() {
+        if (!tracer.enabled()) {
+            queue.wait();
+            return;
+        }
+        const uint64_t begin = tracer.now();
+        queue.wait();
+        tracer.addHost(takeLabel("wait"), index, begin, tracer.now());
+    }
+
+    sycl::queue& get() { return queue; }
+
+private:
+    template <typename F>
+    sycl::event record(const char* name, F&& f) {
+        if (!tracer.enabled()) {
+            return f();
+        }
+        const uint64_t begin = tracer.now();
+        sycl::event event = f();
+        tracer.addCommand(takeLabel(name), index, begin, tracer.now(), event);
+        return event;
+    }
+
+    std::string takeLabel(const char* name) {
+        std::string ret = nextLabel.empty() ? std::string(name) : std::move(nextLabel);
+        nextLabel.clear();
+        return ret;
+    }
+
+    sycl::queue& queue;
+    Tracer& tracer;
+    int index;
+    std::string nextLabel;
+};
+
+}
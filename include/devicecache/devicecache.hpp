@@ -0,0 +1,45 @@
+/*
+// Copyright (c) 2026 Ben Ashbaugh
+//
+// SPDX-License-Identifier: MIT
+*/
+
+#pragma once
+#include <stdlib.h>
+#include <filesystem>
+#include <string>
+#include <system_error>
+
+namespace devicecache
+{
+
+// Enables the persistent on-disk device code cache in the given directory,
+// so kernels compiled by one process are reused by later processes rather
+// than compiled again.  This sets the SYCL_CACHE_PERSISTENT and
+// SYCL_CACHE_DIR environment variables read by the DPC++ runtime, so it
+// must be called before the first SYCL platform or device query.
+//
+// An empty directory does nothing.  Returns false if the directory could
+// not be created or the environment could not be set.
+inline bool enable(const std::string& dir)
+{
+    if (dir.empty()) {
+        return true;
+    }
+
+    std::error_code ec;
+    std::filesystem::create_directories(dir, ec);
+    if (ec) {
+        return false;
+    }
+
+#if defined(_WIN32)
+    return _putenv_s("SYCL_CACHE_PERSISTENT", "1") == 0 &&
+        _putenv_s("SYCL_CACHE_DIR", dir.c_str()) == 0;
+#else
+    return setenv("SYCL_CACHE_PERSISTENT", "1", 1) == 0 &&
+        setenv("SYCL_CACHE_DIR", dir.c_str(), 1) == 0;
+#endif
+}
+
+}
@@ -0,0 +1,301 @@
+/*
+// Copyright (c) 2026 Ben Ashbaugh
+//
+// SPDX-License-Identifier: MIT
+*/
+
+#include <sycl/sycl.hpp>
+#include <popl/popl.hpp>
+
+#include <stdio.h>
+#include <string.h>
+#include <chrono>
+#include <vector>
+
+using test_clock = std::chrono::high_resolution_clock;
+
+// Every pattern runs the same kernel: dst[i] = src[i] + 1.  The source data
+// starts in a host std::vector and the results must end up in another host
+// std::vector, so each pattern includes the copies it needs, whether they
+// are implicit (buffers) or explicit (USM).
+
+static void init(std::vector<uint32_t>& src, std::vector<uint32_t>& dst)
+{
+    for (size_t i = 0; i < src.size(); i++) {
+        src[i] = static_cast<uint32_t>(i);
+    }
+    std::fill(dst.begin(), dst.end(), 0);
+}
+
+static size_t check(const std::vector<uint32_t>& dst)
+{
+    size_t mismatches = 0;
+    for (size_t i = 0; i < dst.size(); i++) {
+        if (dst[i] != i + 1) {
+            if (mismatches < 16) {
+                fprintf(stderr, "MisMatch!  dst[%zu] == %u, want %zu\n", i, dst[i], i + 1);
+            }
+            mismatches++;
+        }
+    }
+    return mismatches;
+}
+
+// Buffers over the host data: copy-in happens when the kernel is submitted,
+// copy-out happens when the destination buffer is destroyed.
+static void runBuffer(sycl::queue& q, std::vector<uint32_t>& src, std::vector<uint32_t>& dst)
+{
+    const size_t n = src.size();
+    sycl::buffer<uint32_t, 1> srcBuf{ src.data(), sycl::range<1>{n} };
+    sycl::buffer<uint32_t, 1> dstBuf{ dst.data(), sycl::range<1>{n} };
+    q.submit([&](sycl::handler& cgh) {
+        sycl::accessor s{ srcBuf, cgh, sycl::read_only };
+        sycl::accessor d{ dstBuf, cgh, sycl::write_only };
+        cgh.parallel_for(sycl::range<1>{n}, [=](sycl::id<1> i) {
+            d[i] = s[i] + 1;
+        });
+    });
+}
+
+// As above, but the destination accessor uses no_init, so the initial
+// destination contents are not copied to the device.
+static void runBufferNoInit(sycl::queue& q, std::vector<uint32_t>& src, std::vector<uint32_t>& dst)
+{
+    const size_t n = src.size();
+    sycl::buffer<uint32_t, 1> srcBuf{ src.data(), sycl::range<1>{n} };
+    sycl::buffer<uint32_t, 1> dstBuf{ dst.data(), sycl::range<1>{n} };
+    q.submit([&](sycl::handler& cgh) {
+        sycl::accessor s{ srcBuf, cgh, sycl::read_only };
+        sycl::accessor d{ dstBuf, cgh, sycl::write_only, sycl::no_init };
+        cgh.parallel_for(sycl::range<1>{n}, [=](sycl::id<1> i) {
+            d[i] = s[i] + 1;
+        });
+    });
+}
+
+// As above, but the buffers must use the host memory directly, which may
+// avoid copies on devices that can access host memory.
+static void runBufferUseHostPtr(sycl::queue& q, std::vector<uint32_t>& src, std::vector<uint32_t>& dst)
+{
+    const size_t n = src.size();
+    const sycl::property_list props{ sycl::property::buffer::use_host_ptr() };
+    sycl::buffer<uint32_t, 1> srcBuf{ src.data(), sycl::range<1>{n}, props };
+    sycl::buffer<uint32_t, 1> dstBuf{ dst.data(), sycl::range<1>{n}, props };
+    q.submit([&](sycl::handler& cgh) {
+        sycl::accessor s{ srcBuf, cgh, sycl::read_only };
+        sycl::accessor d{ dstBuf, cgh, sycl::write_only, sycl::no_init };
+        cgh.parallel_for(sycl::range<1>{n}, [=](sycl::id<1> i) {
+            d[i] = s[i] + 1;
+        });
+    });
+}
+
+// Buffers owned by the SYCL runtime, initialized and read back using host
+// accessors.
+static void runHostAccessor(sycl::queue& q, std::vector<uint32_t>& src, std::vector<uint32_t>& dst)
+{
+    const size_t n = src.size();
+    sycl::buffer<uint32_t, 1> srcBuf{ sycl::range<1>{n} };
+    sycl::buffer<uint32_t, 1> dstBuf{ sycl::range<1>{n} };
+    {
+        sycl::host_accessor s{ srcBuf, sycl::write_only, sycl::no_init };
+        memcpy(s.get_pointer(), src.data(), n * sizeof(uint32_t));
+    }
+    q.submit([&](sycl::handler& cgh) {
+        sycl::accessor s{ srcBuf, cgh, sycl::read_only };
+        sycl::accessor d{ dstBuf, cgh, sycl::write_only, sycl::no_init };
+        cgh.parallel_for(sycl::range<1>{n}, [=](sycl::id<1> i) {
+            d[i] = s[i] + 1;
+        });
+    });
+    {
+        sycl::host_accessor d{ dstBuf, sycl::read_only };
+        memcpy(dst.data(), d.get_pointer(), n * sizeof(uint32_t));
+    }
+}
+
+// USM allocations, with explicit copies and explicit dependencies.  Device
+// allocations are copied with the queue.  Host and shared allocations are
+// copied on the host.
+static void runUSM(sycl::queue& q, sycl::usm::alloc kind, uint32_t* s, uint32_t* d,
+    std::vector<uint32_t>& src, std::vector<uint32_t>& dst)
+{
+    const size_t n = src.size();
+    sycl::event copyIn;
+    if (kind == sycl::usm::alloc::device) {
+        copyIn = q.memcpy(s, src.data(), n * sizeof(uint32_t));
+    } else {
+        memcpy(s, src.data(), n * sizeof(uint32_t));
+    }
+    auto kernel = q.parallel_for(sycl::range<1>{n}, copyIn, [=](sycl::id<1> i) {
+        d[i] = s[i] + 1;
+    });
+    if (kind == sycl::usm::alloc::device) {
+        q.memcpy(dst.data(), d, n * sizeof(uint32_t), kernel).wait();
+    } else {
+        kernel.wait();
+        memcpy(dst.data(), d, n * sizeof(uint32_t));
+    }
+}
+
+int main(int argc, char** argv)
+{
+    int platformIndex = 0;
+    int deviceIndex = 0;
+
+    size_t iterations = 8;
+    size_t minSize = 1024;
+    size_t maxSize = 4 * 1024 * 1024;
+    size_t chain = 256;
+
+    {
+        popl::OptionParser op("Supported Options");
+        op.add<popl::Value<int>>("p", "platform", "Platform Index", platformIndex, &platformIndex);
+        op.add<popl::Value<int>>("d", "device", "Device Index", deviceIndex, &deviceIndex);
+        op.add<popl::Value<size_t>>("i", "iterations", "Iterations per Pattern and Size", iterations, &iterations);
+        op.add<popl::Value<size_t>>("", "min", "Minimum Number of Elements", minSize, &minSize);
+        op.add<popl::Value<size_t>>("", "max", "Maximum Number of Elements", maxSize, &maxSize);
+        op.add<popl::Value<size_t>>("", "chain", "Dependent Kernels for Dependency Tracking Cost", chain, &chain);
+
+        bool printUsage = false;
+        try {
+            op.parse(argc, argv);
+        } catch (std::exception& e) {
+            fprintf(stderr, "Error: %s\n\n", e.what());
+            printUsage = true;
+        }
+
+        if (printUsage || !op.unknown_options().empty() || !op.non_option_args().empty()) {
+            fprintf(stderr,
+                "Usage: buffersvsusm [options]\n"
+                "%s", op.help().c_str());
+            return -1;
+        }
+    }
+
+    sycl::platform platform = sycl::platform::get_platforms()[platformIndex];
+    printf("Running on SYCL platform: %s\n", platform.get_info<sycl::info::platform::name>().c_str());
+
+    sycl::device device = platform.get_devices()[deviceIndex];
+    printf("Running on SYCL device: %s\n", device.get_info<sycl::info::device::name>().c_str());
+
+    sycl::context context = sycl::context{ device };
+    sycl::queue queue = sycl::queue{ context, device };
+
+    const char* names[] = {
+        "buffer", "buffer no_init", "buffer use_host_ptr", "host_accessor",
+        "USM device", "USM host", "USM shared" };
+    const int patterns = sizeof(names) / sizeof(names[0]);
+
+    size_t mismatches = 0;
+
+    printf("\n%12s", "Elements");
+    for (int p = 0; p < patterns; p++) {
+        printf(" %20s", names[p]);
+    }
+    printf("\n");
+
+    for (size_t n = std::max<size_t>(minSize, 1); n <= maxSize; n *= 2) {
+        std::vector<uint32_t> src(n), dst(n);
+
+        uint32_t* d_src = sycl::malloc_device<uint32_t>(n, device, context);
+        uint32_t* d_dst = sycl::malloc_device<uint32_t>(n, device, context);
+        uint32_t* h_src = sycl::malloc_host<uint32_t>(n, context);
+        uint32_t* h_dst = sycl::malloc_host<uint32_t>(n, context);
+        uint32_t* s_src = sycl::malloc_shared<uint32_t>(n, device, context);
+        uint32_t* s_dst = sycl::malloc_shared<uint32_t>(n, device, context);
+
+        printf("%12zu", n);
+        for (int p = 0; p < patterns; p++) {
+            // Warm up once, so kernel compilation is not measured.
+            std::chrono::duration<float> elapsed_seconds{0};
+            for (size_t i = 0; i <= iterations; i++) {
+                init(src, dst);
+                auto start = test_clock::now();
+                switch (p) {
+                case 0: runBuffer(queue, src, dst); break;
+                case 1: runBufferNoInit(queue, src, dst); break;
+                case 2: runBufferUseHostPtr(queue, src, dst); break;
+                case 3: runHostAccessor(queue, src, dst); break;
+                case 4: runUSM(queue, sycl::usm::alloc::device, d_src, d_dst, src, dst); break;
+                case 5: runUSM(queue, sycl::usm::alloc::host, h_src, h_dst, src, dst); break;
+                case 6: runUSM(queue, sycl::usm::alloc::shared, s_src, s_dst, src, dst); break;
+                }
+                auto end = test_clock::now();
+                if (i > 0) {
+                    elapsed_seconds += end - start;
+                }
+                mismatches += check(dst);
+            }
+            const float seconds = elapsed_seconds.count() / std::max<size_t>(iterations, 1);
+            const float gbps = 2.0f * n * sizeof(uint32_t) / seconds / 1e9f;
+            printf(" %9.1f us %5.1f GB/s", seconds * 1e6f, gbps);
+        }
+        printf("\n");
+
+        sycl::free(d_src, context);
+        sycl::free(d_dst, context);
+        sycl::free(h_src, context);
+        sycl::free(h_dst, context);
+        sycl::free(s_src, context);
+        sycl::free(s_dst, context);
+    }
+
+    // Dependency tracking cost: submit a chain of small dependent kernels,
+    // with dependencies tracked implicitly by accessors vs. expressed
+    // explicitly by USM events.
+    if (chain) {
+        const size_t n = 1024;
+        std::vector<uint32_t> data(n, 0);
+
+        auto start = test_clock::now();
+        {
+            sycl::buffer<uint32_t, 1> buf{ data.data(), sycl::range<1>{n} };
+            for (size_t c = 0; c < chain; c++) {
+                queue.submit([&](sycl::handler& cgh) {
+                    sycl::accessor a{ buf, cgh, sycl::read_write };
+                    cgh.parallel_for(sycl::range<1>{n}, [=](sycl::id<1> i) {
+                        a[i] += 1;
+                    });
+                });
+            }
+        }
+        std::chrono::duration<float> buffer_seconds = test_clock::now() - start;
+
+        uint32_t* ptr = sycl::malloc_device<uint32_t>(n, device, context);
+        queue.memset(ptr, 0, n * sizeof(uint32_t)).wait();
+        start = test_clock::now();
+        sycl::event dep;
+        for (size_t c = 0; c < chain; c++) {
+            dep = queue.parallel_for(sycl::range<1>{n}, dep, [=](sycl::id<1> i) {
+                ptr[i] += 1;
+            });
+        }
+        dep.wait();
+        std::chrono::duration<float> usm_seconds = test_clock::now() - start;
+
+        std::vector<uint32_t> result(n);
+        queue.memcpy(result.data(), ptr, n * sizeof(uint32_t)).wait();
+        sycl::free(ptr, context);
+
+        for (size_t i = 0; i < n; i++) {
+            if (data[i] != chain || result[i] != chain) {
+                mismatches++;
+            }
+        }
+
+        printf("\nDependent kernel chain of %zu: accessors %f us per kernel, USM events %f us per kernel\n",
+            chain,
+            buffer_seconds.count() * 1e6f / chain,
+            usm_seconds.count() * 1e6f / chain);
+    }
+
+    if (mismatches) {
+        fprintf(stderr, "Error: Found %zu mismatches!!!\n", mismatches);
+        return -1;
+    }
+
+    printf("Success.\n");
+
+    return 0;
+}
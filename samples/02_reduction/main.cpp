@@ -0,0 +1,284 @@
+/*
+// Copyright (c) 2026 Ben Ashbaugh
+//
+// SPDX-License-Identifier: MIT
+*/
+
+#include <sycl/sycl.hpp>
+#include <popl/popl.hpp>
+
+#include <stdio.h>
+#include <algorithm>
+#include <chrono>
+#include <limits>
+#include <vector>
+
+using test_clock = std::chrono::high_resolution_clock;
+
+// Every strategy computes the sum, minimum, and maximum of the same array
+// in a single pass.  The values are small integers, so the results are
+// exact and can be compared against the host results directly.
+
+struct Result {
+    int sum;
+    int min;
+    int max;
+};
+
+static const Result identity = {
+    0, std::numeric_limits<int>::max(), std::numeric_limits<int>::min() };
+
+static int value(size_t i)
+{
+    return static_cast<int>((i * 7919) % 128) - 64;
+}
+
+static void atomicCombine(Result* dst, int sum, int min, int max)
+{
+    using ref = sycl::atomic_ref<int, sycl::memory_order::relaxed, sycl::memory_scope::device,
+        sycl::access::address_space::global_space>;
+    ref(dst->sum).fetch_add(sum);
+    ref(dst->min).fetch_min(min);
+    ref(dst->max).fetch_max(max);
+}
+
+// sycl::reduction, with three reduction variables in one kernel.  The
+// implementation chooses how to combine partial results.
+static void runReduction(sycl::queue& q, const int* src, size_t n, Result* dst)
+{
+    q.submit([&](sycl::handler& cgh) {
+        cgh.parallel_for(sycl::range<1>{n},
+            sycl::reduction(&dst->sum, sycl::plus<int>()),
+            sycl::reduction(&dst->min, sycl::minimum<int>()),
+            sycl::reduction(&dst->max, sycl::maximum<int>()),
+            [=](sycl::id<1> i, auto& sum, auto& min, auto& max) {
+                const int v = src[i];
+                sum += v;
+                min.combine(v);
+                max.combine(v);
+            });
+    });
+}
+
+// A two-level tree: each work-item accumulates a strided part of the array,
+// each work-group combines its work-items with reduce_over_group and writes
+// a partial result, then a single work-group reduces the partial results.
+static void runWorkGroup(sycl::queue& q, const int* src, size_t n, Result* dst,
+    Result* partials, size_t groups, size_t localSize)
+{
+    q.parallel_for(sycl::nd_range<1>{groups * localSize, localSize}, [=](sycl::nd_item<1> item) {
+        Result r = identity;
+        for (size_t i = item.get_global_id(0); i < n; i += item.get_global_range(0)) {
+            const int v = src[i];
+            r.sum += v;
+            r.min = sycl::min(r.min, v);
+            r.max = sycl::max(r.max, v);
+        }
+        auto g = item.get_group();
+        r.sum = sycl::reduce_over_group(g, r.sum, sycl::plus<int>());
+        r.min = sycl::reduce_over_group(g, r.min, sycl::minimum<int>());
+        r.max = sycl::reduce_over_group(g, r.max, sycl::maximum<int>());
+        if (item.get_local_id(0) == 0) {
+            partials[item.get_group_linear_id()] = r;
+        }
+    });
+    q.parallel_for(sycl::nd_range<1>{localSize, localSize}, [=](sycl::nd_item<1> item) {
+        Result r = identity;
+        for (size_t i = item.get_local_id(0); i < groups; i += localSize) {
+            r.sum += partials[i].sum;
+            r.min = sycl::min(r.min, partials[i].min);
+            r.max = sycl::max(r.max, partials[i].max);
+        }
+        auto g = item.get_group();
+        r.sum = sycl::reduce_over_group(g, r.sum, sycl::plus<int>());
+        r.min = sycl::reduce_over_group(g, r.min, sycl::minimum<int>());
+        r.max = sycl::reduce_over_group(g, r.max, sycl::maximum<int>());
+        if (item.get_local_id(0) == 0) {
+            *dst = r;
+        }
+    });
+}
+
+// Each work-item accumulates a strided part of the array, each sub-group
+// combines its work-items with shuffles, then the first work-item in each
+// sub-group combines its result into the final result with atomics.
+static void runSubGroup(sycl::queue& q, const int* src, size_t n, Result* dst,
+    size_t groups, size_t localSize)
+{
+    q.parallel_for(sycl::nd_range<1>{groups * localSize, localSize}, [=](sycl::nd_item<1> item) {
+        Result r = identity;
+        for (size_t i = item.get_global_id(0); i < n; i += item.get_global_range(0)) {
+            const int v = src[i];
+            r.sum += v;
+            r.min = sycl::min(r.min, v);
+            r.max = sycl::max(r.max, v);
+        }
+
+        // Start from the smallest power of two that covers the sub-group,
+        // so this also works for sub-groups that are not a power of two.
+        auto sg = item.get_sub_group();
+        const size_t size = sg.get_local_linear_range();
+        const size_t lid = sg.get_local_linear_id();
+        size_t offset = 1;
+        while (offset < size) {
+            offset *= 2;
+        }
+        for (offset /= 2; offset > 0; offset /= 2) {
+            const int sum = sycl::shift_group_left(sg, r.sum, offset);
+            const int min = sycl::shift_group_left(sg, r.min, offset);
+            const int max = sycl::shift_group_left(sg, r.max, offset);
+            if (lid + offset < size) {
+                r.sum += sum;
+                r.min = sycl::min(r.min, min);
+                r.max = sycl::max(r.max, max);
+            }
+        }
+        if (lid == 0) {
+            atomicCombine(dst, r.sum, r.min, r.max);
+        }
+    });
+}
+
+// Every work-item combines its element into the final result with atomics.
+// This is the simplest strategy, but all work-items contend for the same
+// three values.
+static void runAtomics(sycl::queue& q, const int* src, size_t n, Result* dst)
+{
+    q.parallel_for(sycl::range<1>{n}, [=](sycl::id<1> i) {
+        const int v = src[i];
+        atomicCombine(dst, v, v, v);
+    });
+}
+
+int main(int argc, char** argv)
+{
+    int platformIndex = 0;
+    int deviceIndex = 0;
+
+    size_t iterations = 8;
+    size_t minSize = 1024;
+    size_t maxSize = 16 * 1024 * 1024;
+    size_t localSize = 256;
+
+    {
+        popl::OptionParser op("Supported Options");
+        op.add<popl::Value<int>>("p", "platform", "Platform Index", platformIndex, &platformIndex);
+        op.add<popl::Value<int>>("d", "device", "Device Index", deviceIndex, &deviceIndex);
+        op.add<popl::Value<size_t>>("i", "iterations", "Iterations per Strategy and Size", iterations, &iterations);
+        op.add<popl::Value<size_t>>("", "min", "Minimum Number of Elements", minSize, &minSize);
+        op.add<popl::Value<size_t>>("", "max", "Maximum Number of Elements", maxSize, &maxSize);
+        op.add<popl::Value<size_t>>("", "lws", "Local Work Size for Work-Group and Sub-Group Strategies", localSize, &localSize);
+
+        bool printUsage = false;
+        try {
+            op.parse(argc, argv);
+        } catch (std::exception& e) {
+            fprintf(stderr, "Error: %s\n\n", e.what());
+            printUsage = true;
+        }
+
+        if (printUsage || !op.unknown_options().empty() || !op.non_option_args().empty()) {
+            fprintf(stderr,
+                "Usage: reduction [options]\n"
+                "%s", op.help().c_str());
+            return -1;
+        }
+    }
+
+    // The sum of up to 16M values between -64 and 63 always fits in an int.
+    if (maxSize > 16 * 1024 * 1024) {
+        fprintf(stderr, "Error: the maximum number of elements is %d\n", 16 * 1024 * 1024);
+        return -1;
+    }
+
+    sycl::platform platform = sycl::platform::get_platforms()[platformIndex];
+    printf("Running on SYCL platform: %s\n", platform.get_info<sycl::info::platform::name>().c_str());
+
+    sycl::device device = platform.get_devices()[deviceIndex];
+    printf("Running on SYCL device: %s\n", device.get_info<sycl::info::device::name>().c_str());
+
+    sycl::context context = sycl::context{ device };
+    sycl::queue queue = sycl::queue{ context, device, sycl::property::queue::in_order() };
+
+    localSize = std::min(std::max<size_t>(localSize, 1),
+        device.get_info<sycl::info::device::max_work_group_size>());
+
+    // Enough work-groups to fill the device, each work-item then loops over
+    // the array.
+    const size_t maxGroups = device.get_info<sycl::info::device::max_compute_units>() * 4;
+
+    const char* names[] = { "sycl::reduction", "reduce_over_group", "sub-group shuffle", "atomics" };
+    const int strategies = sizeof(names) / sizeof(names[0]);
+
+    size_t mismatches = 0;
+
+    printf("\n%12s", "Elements");
+    for (int s = 0; s < strategies; s++) {
+        printf(" %22s", names[s]);
+    }
+    printf("\n");
+
+    int* src = sycl::malloc_device<int>(std::max<size_t>(maxSize, 1), device, context);
+    Result* dst = sycl::malloc_shared<Result>(1, device, context);
+    Result* partials = sycl::malloc_device<Result>(maxGroups, device, context);
+
+    for (size_t n = std::max<size_t>(minSize, 1); n <= maxSize; n *= 2) {
+        std::vector<int> data(n);
+        Result want = identity;
+        for (size_t i = 0; i < n; i++) {
+            data[i] = value(i);
+            want.sum += data[i];
+            want.min = std::min(want.min, data[i]);
+            want.max = std::max(want.max, data[i]);
+        }
+        queue.memcpy(src, data.data(), n * sizeof(int)).wait();
+
+        const size_t groups = std::min(maxGroups, (n + localSize - 1) / localSize);
+
+        printf("%12zu", n);
+        for (int s = 0; s < strategies; s++) {
+            // Warm up once, so kernel compilation is not measured.
+            std::chrono::duration<float> elapsed_seconds{0};
+            for (size_t i = 0; i <= iterations; i++) {
+                *dst = identity;
+                auto start = test_clock::now();
+                switch (s) {
+                case 0: runReduction(queue, src, n, dst); break;
+                case 1: runWorkGroup(queue, src, n, dst, partials, groups, localSize); break;
+                case 2: runSubGroup(queue, src, n, dst, groups, localSize); break;
+                case 3: runAtomics(queue, src, n, dst); break;
+                }
+                queue.wait();
+                auto end = test_clock::now();
+                if (i > 0) {
+                    elapsed_seconds += end - start;
+                }
+
+                if (dst->sum != want.sum || dst->min != want.min || dst->max != want.max) {
+                    if (mismatches < 16) {
+                        fprintf(stderr, "MisMatch!  %s with %zu elements: sum %d min %d max %d, want %d %d %d\n",
+                            names[s], n, dst->sum, dst->min, dst->max, want.sum, want.min, want.max);
+                    }
+                    mismatches++;
+                }
+            }
+            const float seconds = elapsed_seconds.count() / std::max<size_t>(iterations, 1);
+            const float gbps = n * sizeof(int) / seconds / 1e9f;
+            printf(" %11.1f us %5.1f GB/s", seconds * 1e6f, gbps);
+        }
+        printf("\n");
+    }
+
+    sycl::free(src, context);
+    sycl::free(dst, context);
+    sycl::free(partials, context);
+
+    if (mismatches) {
+        fprintf(stderr, "Error: Found %zu mismatches!!!\n", mismatches);
+        return -1;
+    }
+
+    printf("Success.\n");
+
+    return 0;
+}
@@ -0,0 +1,316 @@
+/*
+// Copyright (c) 2026 Ben Ashbaugh
+//
+// SPDX-License-Identifier: MIT
+*/
+
+#include <sycl/sycl.hpp>
+#include <popl/popl.hpp>
+
+#include <stdio.h>
+#include <algorithm>
+#include <chrono>
+#include <numeric>
+#include <vector>
+
+// libstdc++ implements the parallel algorithms with TBB, so they are only
+// used with libstdc++ if TBB was found.  Otherwise, the host baseline is a
+// sequential scan.
+#if __has_include(<execution>) && (!defined(__GLIBCXX__) || defined(SCAN_HAVE_TBB))
+#include <execution>
+#if defined(__cpp_lib_parallel_algorithm)
+#define SCAN_PARALLEL_HOST
+#endif
+#endif
+
+using test_clock = std::chrono::high_resolution_clock;
+
+// Every strategy computes an exclusive or inclusive prefix sum of uint32_t
+// values.  Sums wrap on overflow, the same as on the host, so the results
+// can be compared against the host results directly.
+//
+// Each work-group scans one tile of localSize elements, one element per
+// work-item.
+
+static uint32_t value(size_t i)
+{
+    return static_cast<uint32_t>((i * 7919) % 97);
+}
+
+// Three passes over the data: each work-group reduces its tile to a partial
+// sum, a single work-group scans the partial sums with joint_exclusive_scan,
+// then each work-group scans its tile again with exclusive_scan_over_group
+// and adds the scanned partial sum for its tile.  The partials allocation
+// holds the partial sums followed by the scanned partial sums.
+static void runThreePhase(sycl::queue& q, const uint32_t* src, uint32_t* dst, size_t n,
+    bool inclusive, uint32_t* partials, size_t localSize)
+{
+    const size_t tiles = (n + localSize - 1) / localSize;
+
+    q.parallel_for(sycl::nd_range<1>{tiles * localSize, localSize}, [=](sycl::nd_item<1> item) {
+        const size_t i = item.get_global_id(0);
+        const uint32_t v = i < n ? src[i] : 0;
+        const uint32_t sum = sycl::reduce_over_group(item.get_group(), v, sycl::plus<uint32_t>());
+        if (item.get_local_id(0) == 0) {
+            partials[item.get_group_linear_id()] = sum;
+        }
+    });
+    q.parallel_for(sycl::nd_range<1>{localSize, localSize}, [=](sycl::nd_item<1> item) {
+        sycl::joint_exclusive_scan(item.get_group(), partials, partials + tiles, partials + tiles,
+            sycl::plus<uint32_t>());
+    });
+    q.parallel_for(sycl::nd_range<1>{tiles * localSize, localSize}, [=](sycl::nd_item<1> item) {
+        const size_t i = item.get_global_id(0);
+        const uint32_t v = i < n ? src[i] : 0;
+        const uint32_t prefix = partials[tiles + item.get_group_linear_id()];
+        const uint32_t excl = sycl::exclusive_scan_over_group(item.get_group(), v, sycl::plus<uint32_t>());
+        if (i < n) {
+            dst[i] = prefix + excl + (inclusive ? v : 0);
+        }
+    });
+}
+
+// Single-pass scan with decoupled look-back.  Each work-group takes the next
+// tile from a counter, so earlier tiles are always already running, scans
+// its tile, and publishes its tile sum.  The first work-item then walks
+// back over the earlier tiles, adding tile sums until it finds a tile that
+// has published its inclusive prefix, and publishes the inclusive prefix
+// for its own tile.
+//
+// The status of each tile packs a flag in the upper 32 bits and a value in
+// the lower 32 bits, so the flag and value are published together.
+enum : uint64_t {
+    StatusInvalid = 0,
+    StatusAggregate = 1,
+    StatusPrefix = 2,
+};
+
+static void runLookBack(sycl::queue& q, const uint32_t* src, uint32_t* dst, size_t n,
+    bool inclusive, uint64_t* status, uint32_t* counter, size_t localSize)
+{
+    const size_t tiles = (n + localSize - 1) / localSize;
+
+    q.memset(status, 0, tiles * sizeof(uint64_t));
+    q.memset(counter, 0, sizeof(uint32_t));
+    q.parallel_for(sycl::nd_range<1>{tiles * localSize, localSize}, [=](sycl::nd_item<1> item) {
+        using status_ref = sycl::atomic_ref<uint64_t, sycl::memory_order::relaxed,
+            sycl::memory_scope::device, sycl::access::address_space::global_space>;
+        using counter_ref = sycl::atomic_ref<uint32_t, sycl::memory_order::relaxed,
+            sycl::memory_scope::device, sycl::access::address_space::global_space>;
+
+        auto g = item.get_group();
+        const size_t lid = item.get_local_id(0);
+
+        uint32_t tile = 0;
+        if (lid == 0) {
+            tile = counter_ref(*counter).fetch_add(1);
+        }
+        tile = sycl::group_broadcast(g, tile, 0);
+
+        const size_t i = tile * localSize + lid;
+        const uint32_t v = i < n ? src[i] : 0;
+        const uint32_t excl = sycl::exclusive_scan_over_group(g, v, sycl::plus<uint32_t>());
+        const uint32_t aggregate = sycl::group_broadcast(g, excl + v, localSize - 1);
+
+        uint32_t prefix = 0;
+        if (lid == 0) {
+            if (tile == 0) {
+                status_ref(status[0]).store((StatusPrefix << 32) | aggregate, sycl::memory_order::release);
+            } else {
+                status_ref(status[tile]).store((StatusAggregate << 32) | aggregate, sycl::memory_order::release);
+                for (int64_t t = (int64_t)tile - 1; t >= 0; ) {
+                    const uint64_t s = status_ref(status[t]).load(sycl::memory_order::acquire);
+                    const uint64_t flag = s >> 32;
+                    if (flag == StatusInvalid) {
+                        continue;
+                    }
+                    prefix += static_cast<uint32_t>(s);
+                    if (flag == StatusPrefix) {
+                        break;
+                    }
+                    t--;
+                }
+                status_ref(status[tile]).store((StatusPrefix << 32) | (uint32_t)(prefix + aggregate),
+                    sycl::memory_order::release);
+            }
+        }
+        prefix = sycl::group_broadcast(g, prefix, 0);
+
+        if (i < n) {
+            dst[i] = prefix + excl + (inclusive ? v : 0);
+        }
+    });
+}
+
+#if defined(SCAN_PARALLEL_HOST)
+static const char* hostName = "host par_unseq";
+
+static void runHost(const std::vector<uint32_t>& src, std::vector<uint32_t>& dst, bool inclusive)
+{
+    if (inclusive) {
+        std::inclusive_scan(std::execution::par_unseq, src.begin(), src.end(), dst.begin());
+    } else {
+        std::exclusive_scan(std::execution::par_unseq, src.begin(), src.end(), dst.begin(), 0u);
+    }
+}
+#else
+static const char* hostName = "host sequential";
+
+static void runHost(const std::vector<uint32_t>& src, std::vector<uint32_t>& dst, bool inclusive)
+{
+    if (inclusive) {
+        std::inclusive_scan(src.begin(), src.end(), dst.begin());
+    } else {
+        std::exclusive_scan(src.begin(), src.end(), dst.begin(), 0u);
+    }
+}
+#endif
+
+int main(int argc, char** argv)
+{
+    int platformIndex = 0;
+    int deviceIndex = 0;
+
+    size_t iterations = 8;
+    size_t minSize = 1024;
+    size_t maxSize = 16 * 1024 * 1024;
+    size_t localSize = 256;
+    bool inclusive = false;
+
+    {
+        popl::OptionParser op("Supported Options");
+        op.add<popl::Value<int>>("p", "platform", "Platform Index", platformIndex, &platformIndex);
+        op.add<popl::Value<int>>("d", "device", "Device Index", deviceIndex, &deviceIndex);
+        op.add<popl::Value<size_t>>("i", "iterations", "Iterations per Strategy and Size", iterations, &iterations);
+        op.add<popl::Value<size_t>>("", "min", "Minimum Number of Elements", minSize, &minSize);
+        op.add<popl::Value<size_t>>("", "max", "Maximum Number of Elements", maxSize, &maxSize);
+        op.add<popl::Value<size_t>>("", "lws", "Local Work Size AKA Tile Size", localSize, &localSize);
+        op.add<popl::Switch>("", "inclusive", "Compute an Inclusive Scan Instead of an Exclusive Scan", &inclusive);
+
+        bool printUsage = false;
+        try {
+            op.parse(argc, argv);
+        } catch (std::exception& e) {
+            fprintf(stderr, "Error: %s\n\n", e.what());
+            printUsage = true;
+        }
+
+        if (printUsage || !op.unknown_options().empty() || !op.non_option_args().empty()) {
+            fprintf(stderr,
+                "Usage: scan [options]\n"
+                "%s", op.help().c_str());
+            return -1;
+        }
+    }
+
+    sycl::platform platform = sycl::platform::get_platforms()[platformIndex];
+    printf("Running on SYCL platform: %s\n", platform.get_info<sycl::info::platform::name>().c_str());
+
+    sycl::device device = platform.get_devices()[deviceIndex];
+    printf("Running on SYCL device: %s\n", device.get_info<sycl::info::device::name>().c_str());
+
+    sycl::context context = sycl::context{ device };
+    sycl::queue queue = sycl::queue{ context, device, sycl::property::queue::in_order() };
+
+    localSize = std::min(std::max<size_t>(localSize, 1),
+        device.get_info<sycl::info::device::max_work_group_size>());
+    maxSize = std::max(maxSize, minSize);
+
+    // The look-back status words require 64-bit atomics.
+    const bool lookBack = device.has(sycl::aspect::atomic64);
+    if (!lookBack) {
+        printf("Skipping decoupled look-back, device does not support 64-bit atomics.\n");
+    }
+
+    const char* names[] = { hostName, "three-phase", "decoupled look-back" };
+    const int strategies = sizeof(names) / sizeof(names[0]);
+
+    printf("Computing %s scans with tiles of %zu elements.\n",
+        inclusive ? "inclusive" : "exclusive", localSize);
+    printf("Host baseline: %s\n", hostName);
+
+    size_t mismatches = 0;
+
+    printf("\n%12s", "Elements");
+    for (int s = 0; s < strategies; s++) {
+        printf(" %22s", names[s]);
+    }
+    printf("\n");
+
+    const size_t maxTiles = (maxSize + localSize - 1) / localSize;
+    uint32_t* src = sycl::malloc_device<uint32_t>(maxSize, device, context);
+    uint32_t* dst = sycl::malloc_device<uint32_t>(maxSize, device, context);
+    uint32_t* partials = sycl::malloc_device<uint32_t>(maxTiles * 2, device, context);
+    uint64_t* status = sycl::malloc_device<uint64_t>(maxTiles, device, context);
+    uint32_t* counter = sycl::malloc_device<uint32_t>(1, device, context);
+
+    for (size_t n = std::max<size_t>(minSize, 1); n <= maxSize; n *= 2) {
+        std::vector<uint32_t> data(n), want(n), result(n);
+        for (size_t i = 0; i < n; i++) {
+            data[i] = value(i);
+        }
+        if (inclusive) {
+            std::inclusive_scan(data.begin(), data.end(), want.begin());
+        } else {
+            std::exclusive_scan(data.begin(), data.end(), want.begin(), 0u);
+        }
+        queue.memcpy(src, data.data(), n * sizeof(uint32_t)).wait();
+
+        printf("%12zu", n);
+        for (int s = 0; s < strategies; s++) {
+            if (s == 2 && !lookBack) {
+                printf(" %22s", "n/a");
+                continue;
+            }
+
+            // Warm up once, so kernel compilation is not measured.
+            std::chrono::duration<float> elapsed_seconds{0};
+            for (size_t i = 0; i <= iterations; i++) {
+                std::fill(result.begin(), result.end(), 0);
+                auto start = test_clock::now();
+                switch (s) {
+                case 0: runHost(data, result, inclusive); break;
+                case 1: runThreePhase(queue, src, dst, n, inclusive, partials, localSize); break;
+                case 2: runLookBack(queue, src, dst, n, inclusive, status, counter, localSize); break;
+                }
+                queue.wait();
+                auto end = test_clock::now();
+                if (i > 0) {
+                    elapsed_seconds += end - start;
+                }
+
+                if (s != 0) {
+                    queue.memcpy(result.data(), dst, n * sizeof(uint32_t)).wait();
+                }
+                for (size_t j = 0; j < n; j++) {
+                    if (result[j] != want[j]) {
+                        if (mismatches < 16) {
+                            fprintf(stderr, "MisMatch!  %s with %zu elements: dst[%zu] == %u, want %u\n",
+                                names[s], n, j, result[j], want[j]);
+                        }
+                        mismatches++;
+                    }
+                }
+            }
+            const float seconds = elapsed_seconds.count() / std::max<size_t>(iterations, 1);
+            const float gbps = 2.0f * n * sizeof(uint32_t) / seconds / 1e9f;
+            printf(" %11.1f us %5.1f GB/s", seconds * 1e6f, gbps);
+        }
+        printf("\n");
+    }
+
+    sycl::free(src, context);
+    sycl::free(dst, context);
+    sycl::free(partials, context);
+    sycl::free(status, context);
+    sycl::free(counter, context);
+
+    if (mismatches) {
+        fprintf(stderr, "Error: Found %zu mismatches!!!\n", mismatches);
+        return -1;
+    }
+
+    printf("Success.\n");
+
+    return 0;
+}
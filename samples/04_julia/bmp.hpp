@@ -6,7 +6,16 @@
 
 #pragma once
 #include <fstream>
+#include <vector>
 #include <stdint.h>
+#include <string.h>
+
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
 
 namespace BMP
 {
@@ -128,4 +137,234 @@ static bool save_image(
     return true;
 }
 
+// Writes single channel uint8_t palette indices as an 8bpp palettized BMP
+// file.  The palette contains 256 BGRA colors.
+static bool save_image(
+    const uint8_t *ptr, size_t width, size_t height,
+    const uint32_t *palette,
+    const char *file_name)
+{
+    std::ofstream os(file_name, std::ios::binary);
+    if (!os.good())
+        return false;
+
+    const size_t rowLength = (width + (4 - 1)) & ~(4 - 1);
+    const size_t paletteSize = 256 * sizeof(uint32_t);
+
+    BMPFileHeader file_header = {0};
+    BMPInfoHeader info_header = {0};
+
+    file_header.bf_type_ = 0x4D42; // 'BM'
+    file_header.bf_size_ = static_cast<uint32_t>(
+        sizeof(file_header) + sizeof(info_header) + paletteSize + rowLength * height);
+    file_header.bf_off_bits_ = static_cast<uint32_t>(
+        sizeof(file_header) + sizeof(info_header) + paletteSize);
+    os.write(reinterpret_cast<const char*>(&file_header), sizeof(file_header));
+
+    info_header.bi_size_ = sizeof(BMPInfoHeader);
+    info_header.bi_width_ = static_cast<uint32_t>(width);
+    info_header.bi_height_ = static_cast<uint32_t>(height);
+    info_header.bi_planes_ = 1;
+    info_header.bi_bit_count_ = 8;
+    info_header.bi_compression_ = 0; // BI_RGB
+    info_header.bi_size_image_ = static_cast<uint32_t>(rowLength * height);
+    info_header.bi_clr_used_ = 256;
+    os.write(reinterpret_cast<const char*>(&info_header), sizeof(info_header));
+
+    os.write(reinterpret_cast<const char*>(palette), paletteSize);
+
+    // Each row is written with a single write, including padding.
+    std::vector<uint8_t> row(rowLength, 0);
+    for (int y = 0; y < height; y++) {
+        const uint8_t* ppix = ptr + (height - 1 - y) * width;
+        memcpy(row.data(), ppix, width);
+        os.write(reinterpret_cast<const char*>(row.data()), rowLength);
+    }
+
+    return true;
+}
+
+// Decodes uncompressed 8bpp palettized, 24bpp, or 32bpp BMP data stored
+// either bottom-to-top or top-to-bottom.  Pixels are returned as four
+// channel BGRA uint32_t data with the top row first, which is the same
+// layout save_image expects.  Alpha is set to 0xFF unless the file is
+// 32bpp.
+static bool decode_image(
+    const uint8_t *data, size_t size,
+    std::vector<uint32_t>& pixels, size_t& width, size_t& height)
+{
+    BMPFileHeader file_header;
+    BMPInfoHeader info_header;
+    if (size < sizeof(file_header) + sizeof(info_header))
+        return false;
+    memcpy(&file_header, data, sizeof(file_header));
+    memcpy(&info_header, data + sizeof(file_header), sizeof(info_header));
+
+    if (file_header.bf_type_ != 0x4D42 ||
+        info_header.bi_size_ < sizeof(BMPInfoHeader) ||
+        info_header.bi_compression_ != 0 ||
+        info_header.bi_width_ <= 0 || info_header.bi_height_ == 0)
+        return false;
+
+    const uint32_t bpp = info_header.bi_bit_count_;
+    if (bpp != 8 && bpp != 24 && bpp != 32)
+        return false;
+
+    const bool bottomUp = info_header.bi_height_ > 0;
+    width = static_cast<size_t>(info_header.bi_width_);
+    height = static_cast<size_t>(bottomUp ? info_header.bi_height_ : -info_header.bi_height_);
+
+    const size_t rowLength = (width * bpp / 8 + (4 - 1)) & ~(4 - 1);
+    if (file_header.bf_off_bits_ > size ||
+        rowLength * height > size - file_header.bf_off_bits_)
+        return false;
+
+    uint32_t palette[256] = {0};
+    if (bpp == 8) {
+        const size_t paletteOffset = sizeof(file_header) + info_header.bi_size_;
+        const size_t colors = info_header.bi_clr_used_ ? info_header.bi_clr_used_ : 256;
+        if (colors > 256 || paletteOffset + colors * 4 > file_header.bf_off_bits_)
+            return false;
+        memcpy(palette, data + paletteOffset, colors * 4);
+    }
+
+    pixels.resize(width * height);
+    const uint8_t* bits = data + file_header.bf_off_bits_;
+    for (size_t y = 0; y < height; y++) {
+        const uint8_t* row = bits + (bottomUp ? height - 1 - y : y) * rowLength;
+        uint32_t* dst = pixels.data() + y * width;
+        for (size_t x = 0; x < width; x++) {
+            if (bpp == 8) {
+                dst[x] = palette[row[x]] | 0xFF000000;
+            } else if (bpp == 24) {
+                const uint8_t* p = row + x * 3;
+                dst[x] = p[0] | (p[1] << 8) | (p[2] << 16) | 0xFF000000;
+            } else {
+                memcpy(&dst[x], row + x * 4, 4);
+            }
+        }
+    }
+
+    return true;
+}
+
+// Reads a BMP file, see decode_image.  The file is memory mapped where
+// possible to avoid copying it into a separate buffer.
+static bool load_image(
+    const char *file_name,
+    std::vector<uint32_t>& pixels, size_t& width, size_t& height)
+{
+#if defined(_WIN32)
+    std::ifstream is(file_name, std::ios::binary | std::ios::ate);
+    if (!is.good())
+        return false;
+
+    std::vector<uint8_t> data(static_cast<size_t>(is.tellg()));
+    is.seekg(0);
+    is.read(reinterpret_cast<char*>(data.data()), data.size());
+    if (!is.good())
+        return false;
+
+    return decode_image(data.data(), data.size(), pixels, width, height);
+#else
+    int fd = open(file_name, O_RDONLY);
+    if (fd < 0)
+        return false;
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size == 0) {
+        close(fd);
+        return false;
+    }
+
+    const size_t size = static_cast<size_t>(st.st_size);
+    void* data = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED)
+        return false;
+
+    bool success = decode_image(static_cast<const uint8_t*>(data), size, pixels, width, height);
+    munmap(data, size);
+
+    return success;
+#endif
+}
+
+// A 32bpp BMP file with its pixel array mapped into memory, see map_image.
+struct MappedImage {
+    uint32_t* pixels = nullptr;
+    void* mapping = nullptr;
+    size_t size = 0;
+};
+
+// Creates a 32bpp top-to-bottom BMP file and maps it into memory, so pixels
+// can be written directly into the file without a separate copy.  Row 0 of
+// the pixel array is the top row, which is the same layout save_image
+// expects.  The pixel array starts at a page-aligned offset.  Memory mapping
+// is currently only supported on POSIX systems.
+static bool map_image(
+    size_t width, size_t height,
+    const char *file_name,
+    MappedImage& image)
+{
+#if defined(_WIN32)
+    return false;
+#else
+    const size_t rowLength = width * 4;
+    const size_t pixelOffset = 4096;
+
+    BMPFileHeader file_header = {0};
+    BMPInfoHeader info_header = {0};
+
+    file_header.bf_type_ = 0x4D42; // 'BM'
+    file_header.bf_size_ = static_cast<uint32_t>(pixelOffset + rowLength * height);
+    file_header.bf_off_bits_ = static_cast<uint32_t>(pixelOffset);
+
+    info_header.bi_size_ = sizeof(BMPInfoHeader);
+    info_header.bi_width_ = static_cast<int32_t>(width);
+    info_header.bi_height_ = -static_cast<int32_t>(height);
+    info_header.bi_planes_ = 1;
+    info_header.bi_bit_count_ = 32;
+    info_header.bi_compression_ = 0; // BI_RGB
+    info_header.bi_size_image_ = static_cast<uint32_t>(rowLength * height);
+
+    int fd = open(file_name, O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0)
+        return false;
+
+    const size_t size = pixelOffset + rowLength * height;
+    if (ftruncate(fd, static_cast<off_t>(size)) != 0) {
+        close(fd);
+        return false;
+    }
+
+    void* mapping = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (mapping == MAP_FAILED)
+        return false;
+
+    uint8_t* base = static_cast<uint8_t*>(mapping);
+    memcpy(base, &file_header, sizeof(file_header));
+    memcpy(base + sizeof(file_header), &info_header, sizeof(info_header));
+
+    image.pixels = reinterpret_cast<uint32_t*>(base + pixelOffset);
+    image.mapping = mapping;
+    image.size = size;
+
+    return true;
+#endif
+}
+
+// Unmaps an image mapped by map_image.  The pixels are written to the file
+// by the operating system.
+static void unmap_image(MappedImage& image)
+{
+#if !defined(_WIN32)
+    if (image.mapping) {
+        munmap(image.mapping, image.size);
+    }
+#endif
+    image = MappedImage();
+}
+
 }
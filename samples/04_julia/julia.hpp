@@ -0,0 +1,188 @@
+/*
+// Copyright (c) 2022-2026 Ben Ashbaugh
+//
+// SPDX-License-Identifier: MIT
+*/
+
+#pragma once
+#include <sycl/sycl.hpp>
+#include <algorithm>
+#include <cstdlib>
+#include <vector>
+#include <stdint.h>
+#include <string.h>
+
+// Julia set iteration and coloring helpers, and the basic Julia kernels,
+// shared by the julia sample and the samples that process its images.
+
+// Computes the starting point in the complex plane for pixel (x, y) in an
+// image with the given width.  The pixel coordinates may be fractional, for
+// supersampling.
+template <typename T>
+static inline void juliaStart(float x, float y, int cWidth, T& a, T& b)
+{
+    const T cMinX = T(-1.5f);
+    const T cMaxX = T( 1.5f);
+    const T cMinY = T(-1.5f);
+    const T cMaxY = T( 1.5f);
+
+    a = T(x) * ( cMaxX - cMinX ) / T(cWidth) + cMinX;
+    b = T(y) * ( cMaxY - cMinY ) / T(cWidth) + cMinY;
+}
+
+// Converts an escape result in the range [0, 1] to a BGRA color.
+static inline sycl::uchar4 juliaShade(float result)
+{
+    result = sycl::max( result, 0.0f );
+    result = sycl::min( result, 1.0f );
+
+    // BGRA
+    sycl::float4 color( 1.0f, sycl::sqrt(result), result, 1.0f );
+
+    color *= 255.0f;
+
+    return color.convert<std::uint8_t>();
+}
+
+// Computes the BGRA color of pixel (x, y) in an image with the given width.
+// The iteration is performed with type T, which may be sycl::half, float, or
+// double.  The color is always computed with float precision.
+template <typename T>
+static inline sycl::uchar4 juliaColor(float x, float y, int cWidth, T cr, T ci, int cIterations)
+{
+    T a, b;
+    juliaStart(x, y, cWidth, a, b);
+
+    T result = T(0.0f);
+    const T step = T(1.0f / cIterations);
+    const T thresholdSquared = T(cIterations * cIterations / 64.0f);
+
+    for( int i = 0; i < cIterations; i++ ) {
+        T aa = a * a;
+        T bb = b * b;
+
+        T magnitudeSquared = aa + bb;
+        if( magnitudeSquared >= thresholdSquared ) {
+            break;
+        }
+
+        result += step;
+        b = T(2) * a * b + ci;
+        a = aa - bb + cr;
+    }
+
+    return juliaShade(static_cast<float>(result));
+}
+
+// Computes the number of iterations before pixel (x, y) escapes, up to
+// cIterations.
+static inline int juliaCount(int x, int y, int cWidth, float cr, float ci, int cIterations)
+{
+    float a, b;
+    juliaStart(x, y, cWidth, a, b);
+
+    const float thresholdSquared = cIterations * cIterations / 64.0f;
+
+    int i = 0;
+    for( ; i < cIterations; i++ ) {
+        float aa = a * a;
+        float bb = b * b;
+
+        float magnitudeSquared = aa + bb;
+        if( magnitudeSquared >= thresholdSquared ) {
+            break;
+        }
+
+        b = 2 * a * b + ci;
+        a = aa - bb + cr;
+    }
+
+    return i;
+}
+
+// Returns the number of palette entries used for an iteration limit.
+static inline int juliaLevels(int cIterations)
+{
+    return cIterations < 256 ? cIterations + 1 : 256;
+}
+
+// Builds a 256-entry BGRA palette where index i has the color of the i-th
+// level, so indexed images look the same as directly shaded images.
+static std::vector<uint32_t> juliaPalette(int cIterations)
+{
+    const int levels = juliaLevels(cIterations);
+    std::vector<uint32_t> palette(256, 0);
+    for (int i = 0; i < levels; i++) {
+        sycl::uchar4 color = juliaShade((float)i / (levels - 1));
+        memcpy(&palette[i], &color, sizeof(uint32_t));
+    }
+    return palette;
+}
+
+// Differences between two images: the number of pixels with any channel
+// that differs, and the maximum and mean absolute error per channel.
+struct ImageDiff {
+    size_t mismatches;
+    int maxError;
+    double meanError;
+};
+
+static ImageDiff compareImages(const sycl::uchar4* a, const sycl::uchar4* b, size_t n)
+{
+    ImageDiff diff = { 0, 0, 0.0 };
+    uint64_t sumError = 0;
+    for (size_t p = 0; p < n; p++) {
+        bool differs = false;
+        for (int c = 0; c < 4; c++) {
+            const int error = std::abs((int)a[p][c] - (int)b[p][c]);
+            diff.maxError = std::max(diff.maxError, error);
+            sumError += error;
+            differs |= error != 0;
+        }
+        diff.mismatches += differs;
+    }
+    diff.meanError = n ? (double)sumError / (n * 4) : 0.0;
+    return diff;
+}
+
+template <typename T>
+class Julia {
+public:
+  Julia(sycl::vec<std::uint8_t,4>* _dst, T _cr, T _ci, int _iterations = 16, int _rowOffset = 0) :
+        dst(_dst), cr(_cr), ci(_ci), cIterations(_iterations), rowOffset(_rowOffset) {}
+    void operator()(sycl::item<2> item) const {
+        const int cWidth = item.get_range().get(1);
+
+        int x = item.get_id().get(1);
+        int y = item.get_id().get(0) + rowOffset;
+
+        dst[ y * cWidth + x ] = juliaColor(x, y, cWidth, cr, ci, cIterations);
+    }
+private:
+    sycl::uchar4* dst;
+    T cr;
+    T ci;
+    int cIterations;
+    int rowOffset;
+};
+
+// Count variant: writes the number of iterations before each pixel escapes
+// rather than a color, for histogramming.
+class JuliaCounts {
+public:
+    JuliaCounts(uint32_t* _dst, float _cr, float _ci, int _iterations) :
+        dst(_dst), cr(_cr), ci(_ci), cIterations(_iterations) {}
+    void operator()(sycl::item<2> item) const {
+        const int cWidth = item.get_range().get(1);
+
+        int x = item.get_id().get(1);
+        int y = item.get_id().get(0);
+
+        dst[ y * cWidth + x ] = juliaCount(x, y, cWidth, cr, ci, cIterations);
+    }
+private:
+    uint32_t* dst;
+    float cr;
+    float ci;
+    int cIterations;
+};
@@ -7,68 +7,1183 @@
 #include <sycl/sycl.hpp>
 #include <popl/popl.hpp>
 
+#include <ctype.h>
 #include <stdio.h>
+#include <string.h>
+#include <atomic>
 #include <chrono>
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <future>
+#include <iostream>
+#include <limits>
+#include <optional>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "chrometrace/chrometrace.hpp"
+#include "devicecache/devicecache.hpp"
 
 #include "bmp.hpp"
+#include "julia.hpp"
+#include "png.hpp"
+#include "ppm.hpp"
 
 const char* filename = "julia.bmp";
+const char* pngFilename = "julia.png";
+const char* ppmFilename = "julia.ppm";
+const char* diffFilename = "julia_diff.bmp";
+const char* mappedFilename = "julia_mapped.bmp";
 
 using test_clock = std::chrono::high_resolution_clock;
 
-class Julia {
+#if defined(SYCL_EXT_ONEAPI_GRAPH) || defined(SYCL_EXT_ONEAPI_COPY_OPTIMIZE)
+namespace syclex = sycl::ext::oneapi::experimental;
+#endif
+
+// Palettized variant: writes a single palette index per pixel rather than a
+// BGRA color, reducing the bytes written by 4x.  See juliaPalette.
+class JuliaIndexed {
 public:
-  Julia(sycl::vec<std::uint8_t,4>* _dst, float _cr, float _ci) : dst(_dst), cr(_cr), ci(_ci) {}
+    JuliaIndexed(std::uint8_t* _dst, float _cr, float _ci, int _iterations) :
+        dst(_dst), cr(_cr), ci(_ci), cIterations(_iterations) {}
     void operator()(sycl::item<2> item) const {
-        const float cMinX = -1.5f;
-        const float cMaxX =  1.5f;
-        const float cMinY = -1.5f;
-        const float cMaxY =  1.5f;
+        const int cWidth = item.get_range().get(1);
+        const int levels = juliaLevels(cIterations);
+
+        int x = item.get_id().get(1);
+        int y = item.get_id().get(0);
+
+        int n = juliaCount(x, y, cWidth, cr, ci, cIterations);
+        dst[ y * cWidth + x ] = static_cast<std::uint8_t>(n * (levels - 1) / cIterations);
+    }
+private:
+    std::uint8_t* dst;
+    float cr;
+    float ci;
+    int cIterations;
+};
+
+// Averages samples x samples colors evenly spaced within pixel (x, y).
+static inline sycl::uchar4 juliaSupersample(int x, int y, int cWidth, float cr, float ci, int cIterations, int samples)
+{
+    sycl::float4 sum{ 0.0f, 0.0f, 0.0f, 0.0f };
+    for (int sy = 0; sy < samples; sy++) {
+        for (int sx = 0; sx < samples; sx++) {
+            const float px = x + (sx + 0.5f) / samples - 0.5f;
+            const float py = y + (sy + 0.5f) / samples - 0.5f;
+            sum += juliaColor(px, py, cWidth, cr, ci, cIterations).convert<float>();
+        }
+    }
+    return (sum * (1.0f / (samples * samples)) + 0.5f).convert<std::uint8_t>();
+}
 
+// Supersamples every pixel.
+class JuliaSupersample {
+public:
+    JuliaSupersample(sycl::uchar4* _dst, float _cr, float _ci, int _iterations, int _samples) :
+        dst(_dst), cr(_cr), ci(_ci), cIterations(_iterations), samples(_samples) {}
+    void operator()(sycl::item<2> item) const {
         const int cWidth = item.get_range().get(1);
-        const int cIterations = 16;
 
         int x = item.get_id().get(1);
         int y = item.get_id().get(0);
 
-        float a = x * ( cMaxX - cMinX ) / cWidth + cMinX;
-        float b = y * ( cMaxY - cMinY ) / cWidth + cMinY;
+        dst[ y * cWidth + x ] = juliaSupersample(x, y, cWidth, cr, ci, cIterations, samples);
+    }
+private:
+    sycl::uchar4* dst;
+    float cr;
+    float ci;
+    int cIterations;
+    int samples;
+};
+
+// Edge detection for adaptive supersampling: appends every pixel whose
+// color differs from one of its four neighbors by more than the threshold
+// in any channel to a work list.  The count must be zero before launch.
+class JuliaEdges {
+public:
+    JuliaEdges(const sycl::uchar4* _src, uint32_t* _list, uint32_t* _count, int _threshold) :
+        src(_src), list(_list), count(_count), threshold(_threshold) {}
+    void operator()(sycl::item<2> item) const {
+        const int cWidth = item.get_range().get(1);
+        const int cHeight = item.get_range().get(0);
+
+        int x = item.get_id().get(1);
+        int y = item.get_id().get(0);
+
+        const sycl::uchar4 color = src[ y * cWidth + x ];
+        const int dx[] = { -1, 1, 0, 0 };
+        const int dy[] = { 0, 0, -1, 1 };
+        bool edge = false;
+        for (int n = 0; n < 4; n++) {
+            const int nx = sycl::clamp(x + dx[n], 0, cWidth - 1);
+            const int ny = sycl::clamp(y + dy[n], 0, cHeight - 1);
+            const sycl::uchar4 other = src[ ny * cWidth + nx ];
+            for (int c = 0; c < 4; c++) {
+                edge |= sycl::abs((int)color[c] - (int)other[c]) > threshold;
+            }
+        }
+
+        if (edge) {
+            sycl::atomic_ref<uint32_t,
+                sycl::memory_order::relaxed,
+                sycl::memory_scope::device,
+                sycl::access::address_space::global_space> next(*count);
+            list[next.fetch_add(1u)] = y * cWidth + x;
+        }
+    }
+private:
+    const sycl::uchar4* src;
+    uint32_t* list;
+    uint32_t* count;
+    int threshold;
+};
+
+// Supersamples only the pixels in the work list.
+class JuliaRefine {
+public:
+    JuliaRefine(sycl::uchar4* _dst, const uint32_t* _list, int _width,
+        float _cr, float _ci, int _iterations, int _samples) :
+        dst(_dst), list(_list), cWidth(_width),
+        cr(_cr), ci(_ci), cIterations(_iterations), samples(_samples) {}
+    void operator()(sycl::id<1> id) const {
+        const uint32_t p = list[id];
+
+        int x = p % cWidth;
+        int y = p / cWidth;
+
+        dst[p] = juliaSupersample(x, y, cWidth, cr, ci, cIterations, samples);
+    }
+private:
+    sycl::uchar4* dst;
+    const uint32_t* list;
+    int cWidth;
+    float cr;
+    float ci;
+    int cIterations;
+    int samples;
+};
+
+// Renders with adaptive supersampling: renders at the base resolution,
+// finds edge pixels, and supersamples only the edge pixels.  Compares the
+// time and the error against supersampling every pixel.  dst is left with
+// the adaptive image.
+static void renderAdaptive(
+    sycl::queue& queue, sycl::uchar4* dst,
+    size_t iterations, size_t gwx, size_t gwy, float cr, float ci, int maxIterations,
+    int samples, int threshold)
+{
+    const size_t n = gwx * gwy;
+    sycl::uchar4* full = sycl::malloc_host<sycl::uchar4>(n, queue);
+    uint32_t* list = sycl::malloc_device<uint32_t>(n, queue);
+    uint32_t* count = sycl::malloc_shared<uint32_t>(1, queue);
+
+    // Warm up once, so kernel compilation is not measured.
+    std::chrono::duration<float> base_seconds{0};
+    std::chrono::duration<float> adaptive_seconds{0};
+    std::chrono::duration<float> full_seconds{0};
+    for (size_t i = 0; i <= iterations; i++) {
+        auto start = test_clock::now();
+        queue.parallel_for({gwy, gwx}, Julia(dst, cr, ci, maxIterations));
+        queue.wait();
+        auto based = test_clock::now();
+        *count = 0;
+        queue.parallel_for({gwy, gwx}, JuliaEdges(dst, list, count, threshold));
+        queue.wait();
+        queue.parallel_for(sycl::range<1>{*count}, JuliaRefine(dst, list, (int)gwx, cr, ci, maxIterations, samples));
+        queue.wait();
+        auto end = test_clock::now();
+
+        queue.parallel_for({gwy, gwx}, JuliaSupersample(full, cr, ci, maxIterations, samples));
+        queue.wait();
+        auto fullEnd = test_clock::now();
+
+        if (i > 0) {
+            base_seconds += based - start;
+            adaptive_seconds += end - start;
+            full_seconds += fullEnd - end;
+        }
+    }
+    const size_t refined = *count;
+
+    const ImageDiff diff = compareImages(dst, full, n);
+
+    printf("Adaptive %dx%d supersampling refined %zu of %zu pixels (%.1f%%)\n",
+        samples, samples, refined, n, 100.0 * refined / n);
+    printf("Adaptive finished in %f seconds (base %f seconds) vs. full supersampling in %f seconds, %.2fx speedup\n",
+        adaptive_seconds.count(), base_seconds.count(), full_seconds.count(),
+        full_seconds.count() / adaptive_seconds.count());
+    printf("Error vs. full supersampling: max %d, mean %f per channel\n",
+        diff.maxError, diff.meanError);
+
+    sycl::free(full, queue);
+    sycl::free(list, queue);
+    sycl::free(count, queue);
+}
+
+// A rectangle of pixels for Mariani-Silver subdivision.
+struct Rect {
+    int x;
+    int y;
+    int w;
+    int h;
+};
+
+// Mariani-Silver subdivision: every work-group takes one rectangle from the
+// work list and computes its border.  If every border pixel has the same
+// color, the interior is filled with that color without iterating.
+// Otherwise, the interior is split into four rectangles, which are appended
+// to the work list for the next pass.  Rectangles no larger than minSize in
+// either dimension are computed directly.  The next count must be zero
+// before launch.  The number of pixels that are iterated is accumulated
+// into computed.
+class JuliaSubdivide {
+public:
+    JuliaSubdivide(sycl::uchar4* _dst, const Rect* _rects, Rect* _next, uint32_t* _nextCount,
+        uint32_t* _computed, float _cr, float _ci, int _iterations, int _width, int _minSize) :
+        dst(_dst), rects(_rects), next(_next), nextCount(_nextCount), computed(_computed),
+        cr(_cr), ci(_ci), cIterations(_iterations), cWidth(_width), minSize(_minSize) {}
+    void operator()(sycl::nd_item<1> item) const {
+        using counter = sycl::atomic_ref<uint32_t,
+            sycl::memory_order::relaxed,
+            sycl::memory_scope::device,
+            sycl::access::address_space::global_space>;
+
+        auto g = item.get_group();
+        const Rect r = rects[item.get_group_linear_id()];
+        const int lid = item.get_local_id(0);
+        const int lsize = item.get_local_range(0);
+
+        if (r.w <= minSize || r.h <= minSize) {
+            for (int i = lid; i < r.w * r.h; i += lsize) {
+                const int x = r.x + i % r.w;
+                const int y = r.y + i / r.w;
+                dst[ y * cWidth + x ] = juliaColor(x, y, cWidth, cr, ci, cIterations);
+            }
+            if (lid == 0) {
+                counter(*computed).fetch_add(r.w * r.h);
+            }
+            return;
+        }
+
+        // The border is the top and bottom rows, then the left and right
+        // columns without the corners.
+        const int perimeter = 2 * r.w + 2 * (r.h - 2);
+        sycl::uchar4 corner = juliaColor(r.x, r.y, cWidth, cr, ci, cIterations);
+        bool uniform = true;
+        for (int i = lid; i < perimeter; i += lsize) {
+            int x, y;
+            if (i < 2 * r.w) {
+                x = r.x + i % r.w;
+                y = i < r.w ? r.y : r.y + r.h - 1;
+            } else {
+                const int j = i - 2 * r.w;
+                x = j < r.h - 2 ? r.x : r.x + r.w - 1;
+                y = r.y + 1 + j % (r.h - 2);
+            }
+            const sycl::uchar4 color = juliaColor(x, y, cWidth, cr, ci, cIterations);
+            dst[ y * cWidth + x ] = color;
+            for (int c = 0; c < 4; c++) {
+                uniform &= color[c] == corner[c];
+            }
+        }
+        uniform = sycl::all_of_group(g, uniform);
+
+        const int iw = r.w - 2;
+        const int ih = r.h - 2;
+        if (uniform) {
+            for (int i = lid; i < iw * ih; i += lsize) {
+                const int x = r.x + 1 + i % iw;
+                const int y = r.y + 1 + i / iw;
+                dst[ y * cWidth + x ] = corner;
+            }
+        } else if (lid == 0) {
+            const int hw = iw / 2;
+            const int hh = ih / 2;
+            const uint32_t n = counter(*nextCount).fetch_add(4u);
+            next[n + 0] = Rect{ r.x + 1,      r.y + 1,      hw,      hh      };
+            next[n + 1] = Rect{ r.x + 1 + hw, r.y + 1,      iw - hw, hh      };
+            next[n + 2] = Rect{ r.x + 1,      r.y + 1 + hh, hw,      ih - hh };
+            next[n + 3] = Rect{ r.x + 1 + hw, r.y + 1 + hh, iw - hw, ih - hh };
+        }
+        if (lid == 0) {
+            counter(*computed).fetch_add(perimeter);
+        }
+    }
+private:
+    sycl::uchar4* dst;
+    const Rect* rects;
+    Rect* next;
+    uint32_t* nextCount;
+    uint32_t* computed;
+    float cr;
+    float ci;
+    int cIterations;
+    int cWidth;
+    int minSize;
+};
+
+// Renders the image with Mariani-Silver subdivision, starting from square
+// tiles and running passes until the work list is empty, and compares it
+// to the reference image, which must be a full render.
+static void renderSubdivided(
+    sycl::queue& queue, const sycl::uchar4* reference,
+    size_t gwx, size_t gwy, float cr, float ci, int maxIterations,
+    std::chrono::duration<float> reference_seconds, size_t reference_count)
+{
+    const int tileSize = 64;
+    const int minSize = 4;
+    const size_t localSize = std::min<size_t>(64, queue.get_device().get_info<sycl::info::device::max_work_group_size>());
+    const size_t n = gwx * gwy;
+
+    // Rectangles in a pass never overlap, so there are at most as many
+    // rectangles as pixels.
+    sycl::uchar4* dst = sycl::malloc_host<sycl::uchar4>(n, queue);
+    Rect* rects = sycl::malloc_shared<Rect>(n, queue);
+    Rect* next = sycl::malloc_shared<Rect>(n, queue);
+    uint32_t* counters = sycl::malloc_shared<uint32_t>(2, queue);
+
+    size_t passes = 0;
+    std::chrono::duration<float> elapsed_seconds{0};
+    for (int run = 0; run < 2; run++) {
+        // Warm up once, so kernel compilation is not measured.
+        auto start = test_clock::now();
+        size_t count = 0;
+        for (size_t y = 0; y < gwy; y += tileSize) {
+            for (size_t x = 0; x < gwx; x += tileSize) {
+                rects[count++] = Rect{ (int)x, (int)y,
+                    (int)std::min<size_t>(tileSize, gwx - x), (int)std::min<size_t>(tileSize, gwy - y) };
+            }
+        }
+        counters[1] = 0;
+        for (passes = 0; count > 0; passes++) {
+            counters[0] = 0;
+            queue.parallel_for(sycl::nd_range<1>{count * localSize, localSize},
+                JuliaSubdivide(dst, rects, next, &counters[0], &counters[1],
+                    cr, ci, maxIterations, (int)gwx, minSize));
+            queue.wait();
+            std::swap(rects, next);
+            count = counters[0];
+        }
+        elapsed_seconds = test_clock::now() - start;
+    }
+    const size_t computed = counters[1];
+
+    const size_t mismatches = compareImages(dst, reference, n).mismatches;
+
+    const float per_image = reference_seconds.count() / std::max<size_t>(reference_count, 1);
+    printf("Subdivision finished in %f seconds in %zu passes (%.2fx vs. static per image)\n",
+        elapsed_seconds.count(), passes, per_image / elapsed_seconds.count());
+    printf("Iterated %zu of %zu pixels (%.1f%%)\n", computed, n, 100.0 * computed / n);
+    if (mismatches) {
+        printf("Warning: %zu pixels differ from the full render, the Julia set may not be connected\n",
+            mismatches);
+    } else {
+        printf("Image is identical to the full render.\n");
+    }
+
+    sycl::free(dst, queue);
+    sycl::free(rects, queue);
+    sycl::free(next, queue);
+    sycl::free(counters, queue);
+}
+
+// As juliaColor, but with Brent-style periodicity checking: the orbit is
+// compared to a saved orbit point, and the saved point is replaced with the
+// current point whenever the number of iterations since it was saved
+// reaches a power of two.  If the orbit returns to the saved point, the
+// point is in a cycle and will never escape, so the remaining iterations
+// are skipped.  The remaining steps are still added to the result one at a
+// time, so the result is rounded exactly the same as with juliaColor.
+//
+// Returns the number of iterations that were computed in executed.
+static inline sycl::uchar4 juliaColorPeriodic(int x, int y, int cWidth, float cr, float ci, int cIterations, int& executed)
+{
+    float a, b;
+    juliaStart(x, y, cWidth, a, b);
+
+    float result = 0.0f;
+    const float step = 1.0f / cIterations;
+    const float thresholdSquared = cIterations * cIterations / 64.0f;
+
+    float savedA = a;
+    float savedB = b;
+    int period = 1;
+    int sinceSaved = 0;
+
+    int i = 0;
+    for( ; i < cIterations; i++ ) {
+        float aa = a * a;
+        float bb = b * b;
+
+        float magnitudeSquared = aa + bb;
+        if( magnitudeSquared >= thresholdSquared ) {
+            break;
+        }
+
+        result += step;
+        b = 2 * a * b + ci;
+        a = aa - bb + cr;
+
+        if( a == savedA && b == savedB ) {
+            executed = i + 1;
+            for( i++; i < cIterations; i++ ) {
+                result += step;
+            }
+            return juliaShade(result);
+        }
+        if( ++sinceSaved == period ) {
+            savedA = a;
+            savedB = b;
+            period *= 2;
+            sinceSaved = 0;
+        }
+    }
+
+    executed = i;
+    return juliaShade(result);
+}
+
+// Periodicity checking variant, which also writes the number of iterations
+// that were computed for each pixel.
+class JuliaPeriodic {
+public:
+    JuliaPeriodic(sycl::uchar4* _dst, uint32_t* _executed, float _cr, float _ci, int _iterations) :
+        dst(_dst), executed(_executed), cr(_cr), ci(_ci), cIterations(_iterations) {}
+    void operator()(sycl::item<2> item) const {
+        const int cWidth = item.get_range().get(1);
+
+        int x = item.get_id().get(1);
+        int y = item.get_id().get(0);
+
+        int n = 0;
+        dst[ y * cWidth + x ] = juliaColorPeriodic(x, y, cWidth, cr, ci, cIterations, n);
+        executed[ y * cWidth + x ] = n;
+    }
+private:
+    sycl::uchar4* dst;
+    uint32_t* executed;
+    float cr;
+    float ci;
+    int cIterations;
+};
+
+// Renders the image with periodicity checking and compares it to the
+// reference image, which must be a full render, reporting the time and the
+// average iterations per pixel saved.
+static size_t renderPeriodic(
+    sycl::queue& queue, const sycl::uchar4* reference,
+    size_t iterations, size_t gwx, size_t gwy, float cr, float ci, int maxIterations,
+    std::chrono::duration<float> reference_seconds)
+{
+    const size_t n = gwx * gwy;
+    sycl::uchar4* dst = sycl::malloc_host<sycl::uchar4>(n, queue);
+    uint32_t* executed = sycl::malloc_host<uint32_t>(n, queue);
+    uint32_t* counts = sycl::malloc_host<uint32_t>(n, queue);
+
+    auto start = test_clock::now();
+    for (size_t i = 0; i < iterations; i++) {
+        queue.parallel_for({gwy, gwx}, JuliaPeriodic(dst, executed, cr, ci, maxIterations));
+    }
+    queue.wait();
+    std::chrono::duration<float> elapsed_seconds = test_clock::now() - start;
+
+    // Without periodicity checking, every pixel iterates until it escapes.
+    queue.parallel_for({gwy, gwx}, JuliaCounts(counts, cr, ci, maxIterations)).wait();
+
+    uint64_t without = 0;
+    uint64_t with = 0;
+    for (size_t p = 0; p < n; p++) {
+        without += counts[p];
+        with += executed[p];
+    }
+    const size_t mismatches = compareImages(dst, reference, n).mismatches;
+
+    printf("Periodicity checking finished in %f seconds (%.2fx vs. static)\n",
+        elapsed_seconds.count(),
+        reference_seconds.count() / elapsed_seconds.count());
+    printf("Average iterations per pixel: %.2f without, %.2f with, %.2f saved\n",
+        (double)without / n, (double)with / n, (double)(without - with) / n);
+    if (mismatches) {
+        fprintf(stderr, "Error: %zu pixels differ from the full render\n", mismatches);
+    } else {
+        printf("Image is identical to the full render.\n");
+    }
+
+    sycl::free(dst, queue);
+    sycl::free(executed, queue);
+    sycl::free(counts, queue);
+
+    return mismatches;
+}
+
+// Renders the image with iteration type T and compares it to a reference
+// image, reporting the time and the maximum and mean per-channel error.
+template <typename T>
+static void renderPrecision(
+    sycl::queue& queue, sycl::uchar4* dst, const sycl::uchar4* reference,
+    size_t iterations, size_t gwx, size_t gwy, float cr, float ci, int maxIterations,
+    std::chrono::duration<float> reference_seconds)
+{
+    auto start = test_clock::now();
+    for (size_t i = 0; i < iterations; i++) {
+        queue.parallel_for({gwy, gwx}, Julia<T>(dst, T(cr), T(ci), maxIterations));
+    }
+    queue.wait();
+    std::chrono::duration<float> elapsed_seconds = test_clock::now() - start;
+
+    const ImageDiff diff = compareImages(dst, reference, gwx * gwy);
+
+    printf("Precision variant finished in %f seconds (%.2fx vs. float)\n",
+        elapsed_seconds.count(),
+        reference_seconds.count() / elapsed_seconds.count());
+    printf("Error vs. float: max %d, mean %f per channel\n",
+        diff.maxError, diff.meanError);
+}
+
+// Persistent-threads variant: a fixed number of work-groups repeatedly pull
+// square tiles from an atomic counter in device memory until all tiles have
+// been rendered, so work-groups that finish cheap tiles early pick up more
+// work instead of idling.  The counter must be zero before each launch.
+class JuliaTiles {
+public:
+    JuliaTiles(sycl::uchar4* _dst, unsigned* _counter, float _cr, float _ci, int _iterations,
+        int _width, int _height, int _tileSize) :
+        dst(_dst), counter(_counter), cr(_cr), ci(_ci), cIterations(_iterations),
+        cWidth(_width), cHeight(_height), tileSize(_tileSize) {}
+    void operator()(sycl::nd_item<1> item) const {
+        const unsigned tilesX = (cWidth + tileSize - 1) / tileSize;
+        const unsigned tilesY = (cHeight + tileSize - 1) / tileSize;
+        const int lid = item.get_local_id(0);
+
+        sycl::atomic_ref<unsigned,
+            sycl::memory_order::relaxed,
+            sycl::memory_scope::device,
+            sycl::access::address_space::global_space> nextTile(*counter);
+
+        while (true) {
+            unsigned tile = 0;
+            if (lid == 0) {
+                tile = nextTile.fetch_add(1u);
+            }
+            tile = sycl::group_broadcast(item.get_group(), tile);
+            if (tile >= tilesX * tilesY) {
+                break;
+            }
+
+            int x = (tile % tilesX) * tileSize + lid % tileSize;
+            int y = (tile / tilesX) * tileSize + lid / tileSize;
+            if (x < cWidth && y < cHeight) {
+                dst[ y * cWidth + x ] = juliaColor(x, y, cWidth, cr, ci, cIterations);
+            }
+        }
+    }
+private:
+    sycl::uchar4* dst;
+    unsigned* counter;
+    float cr;
+    float ci;
+    int cIterations;
+    int cWidth;
+    int cHeight;
+    int tileSize;
+};
+
+// Sub-group variant: every work-group renders a square tile, and the lanes
+// of a sub-group iterate together until no lane is still active, so the exit
+// from the loop is uniform across the sub-group.  Optionally, pixels within a
+// tile are assigned in Morton (Z) order so the lanes of a sub-group cover a
+// compact block of the image rather than a thin row.
+//
+// To measure SIMD efficiency, each sub-group accumulates the iterations that
+// did useful work and the iterations it executed across all of its lanes.
+// Counting uses 64-bit atomics, so it is a compile-time choice: the kernel
+// without counting can run on devices without the atomic64 aspect.
+template <bool Count>
+class JuliaSubGroup {
+public:
+    JuliaSubGroup(sycl::uchar4* _dst, uint64_t* _counters, float _cr, float _ci, int _iterations,
+        int _width, int _height, int _tileSize, bool _morton) :
+        dst(_dst), counters(_counters), cr(_cr), ci(_ci), cIterations(_iterations),
+        cWidth(_width), cHeight(_height), tileSize(_tileSize), morton(_morton) {}
+    void operator()(sycl::nd_item<2> item) const {
+        auto sg = item.get_sub_group();
+
+        int lx = item.get_local_id(1);
+        int ly = item.get_local_id(0);
+        if (morton) {
+            unsigned l = item.get_local_linear_id();
+            lx = compactBits(l);
+            ly = compactBits(l >> 1);
+        }
+
+        int x = item.get_group(1) * tileSize + lx;
+        int y = item.get_group(0) * tileSize + ly;
+        bool active = x < cWidth && y < cHeight;
+
+        float a, b;
+        juliaStart(x, y, cWidth, a, b);
 
         float result = 0.0f;
         const float thresholdSquared = cIterations * cIterations / 64.0f;
 
+        unsigned n = 0;
         for( int i = 0; i < cIterations; i++ ) {
-            float aa = a * a;
-            float bb = b * b;
+            if (active) {
+                float aa = a * a;
+                float bb = b * b;
 
-            float magnitudeSquared = aa + bb;
-            if( magnitudeSquared >= thresholdSquared ) {
+                float magnitudeSquared = aa + bb;
+                if( magnitudeSquared >= thresholdSquared ) {
+                    active = false;
+                } else {
+                    result += 1.0f / cIterations;
+                    b = 2 * a * b + ci;
+                    a = aa - bb + cr;
+                    n++;
+                }
+            }
+            if (!sycl::any_of_group(sg, active)) {
                 break;
             }
+        }
 
-            result += 1.0f / cIterations;
-            b = 2 * a * b + ci;
-            a = aa - bb + cr;
+        if (x < cWidth && y < cHeight) {
+            dst[ y * cWidth + x ] = juliaShade(result);
         }
 
-        result = sycl::max( result, 0.0f );
-        result = sycl::min( result, 1.0f );
+        if constexpr (Count) {
+            uint64_t useful = sycl::reduce_over_group(sg, (uint64_t)n, sycl::plus<uint64_t>());
+            uint64_t executed = sycl::reduce_over_group(sg, (uint64_t)n, sycl::maximum<uint64_t>()) *
+                sg.get_local_linear_range();
+            if (sg.get_local_linear_id() == 0) {
+                sycl::atomic_ref<uint64_t,
+                    sycl::memory_order::relaxed,
+                    sycl::memory_scope::device,
+                    sycl::access::address_space::global_space>(counters[0]).fetch_add(useful);
+                sycl::atomic_ref<uint64_t,
+                    sycl::memory_order::relaxed,
+                    sycl::memory_scope::device,
+                    sycl::access::address_space::global_space>(counters[1]).fetch_add(executed);
+            }
+        }
+    }
+private:
+    // Extracts the even bits of a Morton code.
+    static unsigned compactBits(unsigned v) {
+        v &= 0x55555555;
+        v = (v | (v >> 1)) & 0x33333333;
+        v = (v | (v >> 2)) & 0x0F0F0F0F;
+        v = (v | (v >> 4)) & 0x00FF00FF;
+        v = (v | (v >> 8)) & 0x0000FFFF;
+        return v;
+    }
+
+    sycl::uchar4* dst;
+    uint64_t* counters;
+    float cr;
+    float ci;
+    int cIterations;
+    int cWidth;
+    int cHeight;
+    int tileSize;
+    bool morton;
+};
+
+// Computes PNG scanlines for the image using the Paeth filter for every row.
+// Each scanline is the filter type byte followed by the filtered RGB bytes.
+class PNGFilter {
+public:
+    PNGFilter(const sycl::uchar4* _src, std::uint8_t* _dst) : src(_src), dst(_dst) {}
+    void operator()(sycl::item<2> item) const {
+        const int cWidth = item.get_range().get(1);
+
+        int x = item.get_id().get(1);
+        int y = item.get_id().get(0);
 
-        // BGRA
-        sycl::float4 color( 1.0f, sycl::sqrt(result), result, 1.0f );
+        std::uint8_t* row = dst + (size_t)y * (cWidth * 3 + 1);
+        if (x == 0) {
+            row[0] = 4; // Paeth
+        }
 
-        color *= 255.0f;
+        const sycl::uchar4 zero(0, 0, 0, 0);
+        const sycl::uchar4 cur = src[ y * cWidth + x ];
+        const sycl::uchar4 left = x > 0 ? src[ y * cWidth + x - 1 ] : zero;
+        const sycl::uchar4 up = y > 0 ? src[ (y - 1) * cWidth + x ] : zero;
+        const sycl::uchar4 upLeft = x > 0 && y > 0 ? src[ (y - 1) * cWidth + x - 1 ] : zero;
 
-        dst[ y * cWidth + x ] = color.convert<std::uint8_t>();
+        // BGRA to RGB
+        for (int c = 0; c < 3; c++) {
+            const int s = 2 - c;
+            row[1 + x * 3 + c] = static_cast<std::uint8_t>(
+                cur[s] - PNG::paeth_predictor(left[s], up[s], upLeft[s]));
+        }
     }
 private:
-    sycl::uchar4* dst;
+    const sycl::uchar4* src;
+    std::uint8_t* dst;
+};
+
+// Writes the image in each requested format, reporting the bytes written
+// and the time to encode and write each file.
+// If indices is not null, the BMP file is written as a palettized 8bpp
+// file instead.
+static bool saveImages(
+    sycl::queue& queue, const sycl::uchar4* ptr, size_t gwx, size_t gwy,
+    const std::string& format, unsigned threads, bool deviceFilter,
+    const std::uint8_t* indices = nullptr, const uint32_t* palette = nullptr)
+{
+    const bool all = format == "all";
+    bool success = true;
+
+    auto report = [&](const char* name, const char* file, bool ok, test_clock::time_point start) {
+        std::chrono::duration<float> seconds = test_clock::now() - start;
+        if (ok) {
+            printf("Wrote image file %s: %ju bytes in %f seconds\n",
+                file, (uintmax_t)std::filesystem::file_size(file), seconds.count());
+        } else {
+            fprintf(stderr, "Error: could not write %s image file %s\n", name, file);
+            success = false;
+        }
+    };
+
+    if (all || format == "bmp") {
+        auto start = test_clock::now();
+        bool ok = indices ?
+            BMP::save_image(indices, gwx, gwy, palette, filename) :
+            BMP::save_image(reinterpret_cast<const uint32_t*>(ptr), gwx, gwy, filename);
+        report("BMP", filename, ok, start);
+    }
+    if (all || format == "ppm") {
+        auto start = test_clock::now();
+        bool ok = PPM::save_image(reinterpret_cast<const uint32_t*>(ptr), gwx, gwy, ppmFilename);
+        report("PPM", ppmFilename, ok, start);
+    }
+    if (all || format == "png") {
+        auto start = test_clock::now();
+        std::uint8_t* filtered = nullptr;
+        if (deviceFilter) {
+            filtered = sycl::malloc_host<std::uint8_t>(gwy * (gwx * 3 + 1), queue);
+            queue.parallel_for({gwy, gwx}, PNGFilter(ptr, filtered)).wait();
+        }
+        bool ok = PNG::save_image(reinterpret_cast<const uint32_t*>(ptr), gwx, gwy, pngFilename,
+            threads, filtered);
+        report("PNG", pngFilename, ok, start);
+        sycl::free(filtered, queue);
+    }
+
+    return success;
+}
+
+// Compares an image to a reference image on the device, writing the
+// per-pixel absolute difference to diff and reporting the maximum and mean
+// per-channel error.  Alpha is ignored.  Returns the PSNR in dB, which is
+// infinite if the images are identical.
+static double diffImages(
+    sycl::queue& queue, const sycl::uchar4* image, const std::vector<uint32_t>& reference,
+    sycl::uchar4* diff)
+{
+    const size_t count = reference.size();
+    sycl::uchar4* ref = sycl::malloc_host<sycl::uchar4>(count, queue);
+    memcpy(ref, reference.data(), count * sizeof(uint32_t));
+
+    // maximum error, sum of errors, sum of squared errors
+    uint64_t* results = sycl::malloc_shared<uint64_t>(3, queue);
+    results[0] = results[1] = results[2] = 0;
+
+    queue.submit([&](sycl::handler& cgh) {
+        cgh.parallel_for(sycl::range<1>{count},
+            sycl::reduction(results + 0, sycl::maximum<uint64_t>()),
+            sycl::reduction(results + 1, sycl::plus<uint64_t>()),
+            sycl::reduction(results + 2, sycl::plus<uint64_t>()),
+            [=](sycl::id<1> i, auto& maxError, auto& sumError, auto& sumSquared) {
+                const sycl::uchar4 a = image[i];
+                const sycl::uchar4 b = ref[i];
+                sycl::uchar4 d(0, 0, 0, 255);
+                for (int c = 0; c < 3; c++) {
+                    const int e = a[c] > b[c] ? a[c] - b[c] : b[c] - a[c];
+                    d[c] = static_cast<std::uint8_t>(e);
+                    maxError.combine(e);
+                    sumError += e;
+                    sumSquared += e * e;
+                }
+                diff[i] = d;
+            });
+    }).wait();
+
+    const double mse = (double)results[2] / (count * 3);
+    const double psnr = mse > 0.0 ?
+        10.0 * std::log10(255.0 * 255.0 / mse) :
+        std::numeric_limits<double>::infinity();
+    printf("Difference vs. golden image: max %ju, mean %f per channel, PSNR %f dB\n",
+        (uintmax_t)results[0], (double)results[1] / (count * 3), psnr);
+
+    sycl::free(results, queue);
+    sycl::free(ref, queue);
+
+    return psnr;
+}
+
+// Each render device renders bands of rows of the image.  Devices from the
+// same platform share a context and a host USM image.  Bands rendered into
+// the image of a different platform are copied into the primary image
+// after rendering.
+struct RenderDevice {
+    RenderDevice(const sycl::device& _device, const sycl::context& _context, sycl::uchar4* _image) :
+        device(_device), queue(_context, _device, sycl::property::queue::in_order()), image(_image) {}
+
+    sycl::device device;
+    sycl::queue queue;
+    sycl::uchar4* image;
+    size_t rowStart = 0;
+    size_t rowCount = 0;
+    size_t rowsRendered = 0;
+    std::vector<std::pair<size_t, size_t>> bands;
+};
+
+static std::vector<sycl::device> parseDevices(const std::string& list)
+{
+    std::vector<sycl::device> devices;
+    auto platforms = sycl::platform::get_platforms();
+    if (list == "all") {
+        for (auto& p : platforms) {
+            for (auto& d : p.get_devices()) {
+                devices.push_back(d);
+            }
+        }
+        return devices;
+    }
+
+    size_t pos = 0;
+    while (pos < list.size()) {
+        size_t end = list.find(',', pos);
+        if (end == std::string::npos) {
+            end = list.size();
+        }
+        int pi = 0, di = 0;
+        std::string entry = list.substr(pos, end - pos);
+        if (sscanf(entry.c_str(), "%d:%d", &pi, &di) != 2 ||
+            pi < 0 || pi >= (int)platforms.size() ||
+            di < 0 || di >= (int)platforms[pi].get_devices().size()) {
+            fprintf(stderr, "Error: invalid device %s, expected platform:device\n", entry.c_str());
+            return {};
+        }
+        devices.push_back(platforms[pi].get_devices()[di]);
+        pos = end + 1;
+    }
+    return devices;
+}
+
+static int renderMultiDevice(
+    const std::string& deviceList, bool dynamic, size_t chunkRows,
+    size_t iterations, size_t gwx, size_t gwy, float cr, float ci, int maxIterations)
+{
+    auto devices = parseDevices(deviceList);
+    if (devices.empty()) {
+        fprintf(stderr, "Error: no devices to render on\n");
+        return -1;
+    }
+
+    std::vector<sycl::context> contexts;
+    std::vector<sycl::uchar4*> images;
+    std::vector<RenderDevice> renderDevices;
+    for (auto& d : devices) {
+        auto platform = d.get_platform();
+        size_t c = 0;
+        while (c < contexts.size() && contexts[c].get_platform() != platform) {
+            c++;
+        }
+        if (c == contexts.size()) {
+            std::vector<sycl::device> platformDevices;
+            for (auto& pd : devices) {
+                if (pd.get_platform() == platform) {
+                    platformDevices.push_back(pd);
+                }
+            }
+            contexts.push_back(sycl::context{ platformDevices });
+            images.push_back(sycl::malloc<sycl::uchar4>(gwx * gwy, d, contexts[c], sycl::usm::alloc::host));
+        }
+
+        renderDevices.emplace_back(d, contexts[c], images[c]);
+
+        printf("Rendering on SYCL device: %s (%s)\n",
+            d.get_info<sycl::info::device::name>().c_str(),
+            platform.get_info<sycl::info::platform::name>().c_str());
+    }
+
+    // Calibrate: time a band of rows from the middle of the image on each
+    // device, after a warm-up launch to exclude JIT compilation.
+    const size_t calibrationRows = std::min<size_t>(gwy, 64);
+    const size_t calibrationStart = (gwy - calibrationRows) / 2;
+    std::vector<double> rates;
+    double totalRate = 0.0;
+    for (auto& rd : renderDevices) {
+        Julia julia(rd.image, cr, ci, maxIterations, (int)calibrationStart);
+        rd.queue.parallel_for({calibrationRows, gwx}, julia).wait();
+        auto start = test_clock::now();
+        rd.queue.parallel_for({calibrationRows, gwx}, julia).wait();
+        std::chrono::duration<double> seconds = test_clock::now() - start;
+        double rate = calibrationRows / std::max(seconds.count(), 1e-9);
+        rates.push_back(rate);
+        totalRate += rate;
+    }
+
+    if (!dynamic) {
+        size_t row = 0;
+        for (size_t i = 0; i < renderDevices.size(); i++) {
+            auto& rd = renderDevices[i];
+            rd.rowStart = row;
+            rd.rowCount = (i == renderDevices.size() - 1) ?
+                gwy - row :
+                std::min<size_t>(gwy - row, (size_t)(gwy * rates[i] / totalRate));
+            row += rd.rowCount;
+            rd.bands.push_back({rd.rowStart, rd.rowCount});
+        }
+    }
+
+    auto start = test_clock::now();
+    for (size_t i = 0; i < iterations; i++) {
+        if (dynamic) {
+            // Each device pulls the next chunk of rows from a shared work
+            // counter until all rows have been rendered.
+            std::atomic<size_t> nextRow{0};
+            std::vector<std::thread> threads;
+            for (auto& rd : renderDevices) {
+                rd.bands.clear();
+                RenderDevice* prd = &rd;
+                threads.emplace_back([&nextRow, prd, chunkRows, gwx, gwy, cr, ci, maxIterations]() {
+                    size_t row;
+                    while ((row = nextRow.fetch_add(chunkRows)) < gwy) {
+                        size_t rows = std::min(chunkRows, gwy - row);
+                        prd->queue.parallel_for({rows, gwx}, Julia(prd->image, cr, ci, maxIterations, (int)row)).wait();
+                        prd->bands.push_back({row, rows});
+                    }
+                });
+            }
+            for (auto& t : threads) {
+                t.join();
+            }
+        } else {
+            for (auto& rd : renderDevices) {
+                if (rd.rowCount) {
+                    rd.queue.parallel_for({rd.rowCount, gwx}, Julia(rd.image, cr, ci, maxIterations, (int)rd.rowStart));
+                }
+            }
+            for (auto& rd : renderDevices) {
+                rd.queue.wait();
+            }
+        }
+        for (auto& rd : renderDevices) {
+            for (auto& band : rd.bands) {
+                rd.rowsRendered += band.second;
+            }
+        }
+    }
+    auto end = test_clock::now();
+    std::chrono::duration<float> elapsed_seconds = end - start;
+    printf("Finished in %f seconds\n", elapsed_seconds.count());
+
+    // Gather bands rendered into the images of other platforms.
+    for (auto& rd : renderDevices) {
+        if (rd.image != images[0]) {
+            for (auto& band : rd.bands) {
+                memcpy(images[0] + band.first * gwx, rd.image + band.first * gwx,
+                    band.second * gwx * sizeof(sycl::uchar4));
+            }
+        }
+    }
+
+    for (size_t i = 0; i < renderDevices.size(); i++) {
+        const auto& rd = renderDevices[i];
+        printf("%s: %zu rows (%.1f%%), calibrated %.0f rows/s\n",
+            rd.device.get_info<sycl::info::device::name>().c_str(),
+            rd.rowsRendered / iterations,
+            100.0 * rd.rowsRendered / (iterations * gwy),
+            rates[i]);
+    }
+
+    BMP::save_image(reinterpret_cast<const uint32_t*>(images[0]), gwx, gwy, filename);
+    printf("Wrote image file %s\n", filename);
+
+    for (size_t c = 0; c < contexts.size(); c++) {
+        sycl::free(images[c], contexts[c]);
+    }
+
+    printf("... done!\n");
+
+    return 0;
+}
+
+using julia_bundle = sycl::kernel_bundle<sycl::bundle_state::executable>;
+
+// Builds the Julia kernel for the device.  This may be called on a
+// background thread, so the kernel compiles while the host initializes.
+static julia_bundle buildJulia(const sycl::context& context, const sycl::device& device)
+{
+    return sycl::get_kernel_bundle<sycl::bundle_state::executable>(
+        context, { device }, { sycl::get_kernel_id<Julia<float>>() });
+}
+
+// Renders the image, using a prebuilt kernel bundle if there is one.
+static sycl::event submitJulia(chrometrace::Queue& queue, const std::optional<julia_bundle>& bundle,
+    sycl::uchar4* dst, size_t gwx, size_t gwy, float cr, float ci, int maxIterations)
+{
+    return queue.submit([&](sycl::handler& cgh) {
+        if (bundle) {
+            cgh.use_kernel_bundle(*bundle);
+        }
+        cgh.parallel_for(sycl::range<2>{gwy, gwx}, Julia(dst, cr, ci, maxIterations));
+    });
+}
+
+// A render job for batch mode.  The output format is chosen by the output
+// file extension: .png, .ppm, or otherwise BMP.
+struct RenderJob {
+    size_t gwx;
+    size_t gwy;
     float cr;
     float ci;
+    int iterations;
+    std::string output;
 };
 
+// Parses a job line: width height cr ci iterations output.  The output is
+// the rest of the line, so it may contain spaces.
+static bool parseJob(const std::string& line, RenderJob& job)
+{
+    std::istringstream is(line);
+    if (!(is >> job.gwx >> job.gwy >> job.cr >> job.ci >> job.iterations)) {
+        return false;
+    }
+    std::getline(is >> std::ws, job.output);
+    while (!job.output.empty() && isspace((unsigned char)job.output.back())) {
+        job.output.pop_back();
+    }
+    return job.gwx > 0 && job.gwy > 0 && job.iterations > 0 && !job.output.empty();
+}
+
+static bool saveJob(const sycl::uchar4* ptr, const RenderJob& job, unsigned threads)
+{
+    const uint32_t* pixels = reinterpret_cast<const uint32_t*>(ptr);
+    const std::string ext = std::filesystem::path(job.output).extension().string();
+    if (ext == ".png") {
+        return PNG::save_image(pixels, job.gwx, job.gwy, job.output.c_str(), threads);
+    }
+    if (ext == ".ppm") {
+        return PPM::save_image(pixels, job.gwx, job.gwy, job.output.c_str());
+    }
+    return BMP::save_image(pixels, job.gwx, job.gwy, job.output.c_str());
+}
+
+// Renders jobs read one per line from a job file, or from stdin if the
+// file is "-", until the end of the input.  Blank lines and lines starting
+// with # are skipped.  The queue, kernel, and output buffers are reused for
+// every job.  There are two output buffers, so the next job renders into
+// one buffer while the previous job is written from the other buffer on a
+// background thread.  A buffer grows when a job needs a larger image.
+static int renderJobs(chrometrace::Queue& queue, const std::optional<julia_bundle>& bundle,
+    const std::string& jobsFile, unsigned threads)
+{
+    std::ifstream file;
+    if (jobsFile != "-") {
+        file.open(jobsFile);
+        if (!file.good()) {
+            fprintf(stderr, "Error: could not open job file %s\n", jobsFile.c_str());
+            return -1;
+        }
+    }
+    std::istream& in = jobsFile == "-" ? std::cin : file;
+
+    struct JobBuffer {
+        sycl::uchar4* ptr = nullptr;
+        size_t capacity = 0;
+        std::future<bool> writing;
+    };
+    JobBuffer buffers[2];
+
+    size_t jobs = 0;
+    size_t failures = 0;
+    size_t allocations = 0;
+    size_t lineNumber = 0;
+    std::chrono::duration<float> render_seconds{0};
+
+    auto start = test_clock::now();
+    std::string line;
+    while (std::getline(in, line)) {
+        lineNumber++;
+        const size_t first = line.find_first_not_of(" \t\r");
+        if (first == std::string::npos || line[first] == '#') {
+            continue;
+        }
+
+        RenderJob job;
+        if (!parseJob(line, job)) {
+            fprintf(stderr, "Error: could not parse job on line %zu: %s\n", lineNumber, line.c_str());
+            failures++;
+            continue;
+        }
+
+        // The job before the previous job may still be writing this buffer.
+        JobBuffer& buffer = buffers[jobs % 2];
+        if (buffer.writing.valid() && !buffer.writing.get()) {
+            failures++;
+        }
+
+        const size_t n = job.gwx * job.gwy;
+        if (buffer.capacity < n) {
+            sycl::free(buffer.ptr, queue.get());
+            buffer.ptr = sycl::malloc_host<sycl::uchar4>(n, queue.get());
+            buffer.capacity = n;
+            allocations++;
+        }
+
+        auto render_start = test_clock::now();
+        submitJulia(queue.label("julia job"), bundle, buffer.ptr,
+            job.gwx, job.gwy, job.cr, job.ci, job.iterations);
+        queue.wait();
+        render_seconds += test_clock::now() - render_start;
+
+        buffer.writing = std::async(std::launch::async, [ptr = buffer.ptr, job, threads]() {
+            const bool ok = saveJob(ptr, job, threads);
+            if (!ok) {
+                fprintf(stderr, "Error: could not write image file %s\n", job.output.c_str());
+            }
+            return ok;
+        });
+        jobs++;
+    }
+
+    for (auto& buffer : buffers) {
+        if (buffer.writing.valid() && !buffer.writing.get()) {
+            failures++;
+        }
+    }
+    std::chrono::duration<float> elapsed_seconds = test_clock::now() - start;
+
+    printf("Rendered %zu jobs in %f seconds (%f seconds rendering), %.2f jobs/s, %zu buffer allocations\n",
+        jobs, elapsed_seconds.count(), render_seconds.count(),
+        jobs / elapsed_seconds.count(), allocations);
+
+    for (auto& buffer : buffers) {
+        sycl::free(buffer.ptr, queue.get());
+    }
+
+    if (failures) {
+        fprintf(stderr, "Error: %zu jobs failed\n", failures);
+        return -1;
+    }
+    return 0;
+}
+
 int main(int argc, char** argv)
 {
+    const auto program_start = test_clock::now();
+
     int platformIndex = 0;
     int deviceIndex = 0;
 
@@ -76,6 +1191,51 @@ int main(int argc, char** argv)
     size_t gwx = 512;
     size_t gwy = 512;
 
+    float cr = -0.123f;
+    float ci = 0.745f;
+    int maxIterations = 16;
+
+    bool graph = false;
+
+    std::string devices;
+    bool dynamic = false;
+    size_t chunkRows = 32;
+
+    bool persistent = false;
+    size_t tileSize = 8;
+    size_t groups = 0;
+
+    bool subgroup = false;
+    bool morton = false;
+
+    bool subdivide = false;
+
+    bool periodicity = false;
+
+    std::string precision = "float";
+
+    std::string format = "bmp";
+    unsigned threads = 0;
+    bool deviceFilter = false;
+
+    int samples = 0;
+    int threshold = 16;
+
+    bool indexed = false;
+
+    std::string golden;
+    double minPSNR = 40.0;
+    std::string saveGolden;
+
+    bool mapped = false;
+
+    std::string traceFile;
+
+    bool prebuild = false;
+    std::string cacheDir;
+
+    std::string jobsFile;
+
     {
         popl::OptionParser op("Supported Options");
         op.add<popl::Value<int>>("p", "platform", "Platform Index", platformIndex, &platformIndex);
@@ -83,6 +1243,35 @@ int main(int argc, char** argv)
         op.add<popl::Value<size_t>>("i", "iterations", "Iterations", iterations, &iterations);
         op.add<popl::Value<size_t>>("", "gwx", "Global Work Size X AKA Image Width", gwx, &gwx);
         op.add<popl::Value<size_t>>("", "gwy", "Global Work Size Y AKA Image Height", gwy, &gwy);
+        op.add<popl::Value<float>>("", "cr", "Julia Constant Real Part", cr, &cr);
+        op.add<popl::Value<float>>("", "ci", "Julia Constant Imaginary Part", ci, &ci);
+        op.add<popl::Value<int>>("", "maxiter", "Maximum Escape Iterations per Pixel", maxIterations, &maxIterations);
+        op.add<popl::Switch>("", "graph", "Record Launches Once and Replay Them", &graph);
+        op.add<popl::Value<std::string>>("", "devices", "Render Across Devices: 'all' or a List of platform:device", devices, &devices);
+        op.add<popl::Switch>("", "dynamic", "Distribute Rows Across Devices Dynamically", &dynamic);
+        op.add<popl::Value<size_t>>("", "chunk", "Rows per Chunk for Dynamic Distribution", chunkRows, &chunkRows);
+        op.add<popl::Switch>("", "persistent", "Also Render with Persistent Work-Groups Pulling Tiles", &persistent);
+        op.add<popl::Value<size_t>>("", "tile", "Tile Size for Persistent and Sub-Group Work-Groups", tileSize, &tileSize);
+        op.add<popl::Value<size_t>>("", "groups", "Number of Persistent Work-Groups (0 = Auto)", groups, &groups);
+        op.add<popl::Switch>("", "subgroup", "Also Render with Sub-Group Uniform Early Exit", &subgroup);
+        op.add<popl::Switch>("", "morton", "Assign Pixels in Morton Order for Sub-Group Rendering", &morton);
+        op.add<popl::Switch>("", "subdivide", "Also Render with Mariani-Silver Subdivision", &subdivide);
+        op.add<popl::Switch>("", "periodicity", "Also Render with Periodicity Checking for Bounded Points", &periodicity);
+        op.add<popl::Value<std::string>>("", "precision", "Iteration Precision: half, float, or double", precision, &precision);
+        op.add<popl::Value<std::string>>("", "format", "Output Format: bmp, png, ppm, or all", format, &format);
+        op.add<popl::Value<unsigned>>("", "threads", "Threads for PNG Compression (0 = Auto)", threads, &threads);
+        op.add<popl::Switch>("", "device-filter", "Compute PNG Row Filters on the Device", &deviceFilter);
+        op.add<popl::Value<int>>("", "aa", "Adaptive Supersampling Samples per Axis (0 = Off)", samples, &samples);
+        op.add<popl::Value<int>>("", "aa-threshold", "Color Difference that Marks an Edge Pixel for Supersampling", threshold, &threshold);
+        op.add<popl::Switch>("", "indexed", "Also Render Palette Indices and Write an 8bpp BMP", &indexed);
+        op.add<popl::Value<std::string>>("", "golden", "Golden BMP Image to Compare Against", golden, &golden);
+        op.add<popl::Value<double>>("", "psnr", "Minimum PSNR in dB to Match the Golden Image", minPSNR, &minPSNR);
+        op.add<popl::Value<std::string>>("", "save-golden", "Write the Image to Compare as a Golden BMP Image", saveGolden, &saveGolden);
+        op.add<popl::Switch>("", "mmap", "Also Render Directly into a Memory-Mapped BMP File", &mapped);
+        op.add<popl::Value<std::string>>("", "jobs", "Render Jobs from File, or - for stdin, One per Line: width height cr ci iterations output", jobsFile, &jobsFile);
+        op.add<popl::Switch>("", "prebuild", "Build the Julia Kernel on a Background Thread During Startup", &prebuild);
+        op.add<popl::Value<std::string>>("", "cache-dir", "Cache Compiled Device Code in Directory", cacheDir, &cacheDir);
+        op.add<popl::Value<std::string>>("", "trace", "Write a Chrome Trace of Queue Activity to File", traceFile, &traceFile);
 
         bool printUsage = false;
         try {
@@ -100,32 +1289,414 @@ int main(int argc, char** argv)
         }
     }
 
-    sycl::platform platform = sycl::platform::get_platforms()[platformIndex];
-    printf("Running on SYCL platform: %s\n", platform.get_info<sycl::info::platform::name>().c_str());
+    // The per-iteration statistics divide by the number of iterations.
+    if (iterations < 1) {
+        fprintf(stderr, "Error: iterations must be at least 1\n");
+        return -1;
+    }
+
+    if (precision != "half" && precision != "float" && precision != "double") {
+        fprintf(stderr, "Error: unknown precision %s\n", precision.c_str());
+        return -1;
+    }
+
+    if (format != "bmp" && format != "png" && format != "ppm" && format != "all") {
+        fprintf(stderr, "Error: unknown format %s\n", format.c_str());
+        return -1;
+    }
+
+    if (!devicecache::enable(cacheDir)) {
+        fprintf(stderr, "Error: could not enable the device code cache in %s\n", cacheDir.c_str());
+        return -1;
+    }
 
+    if (!devices.empty()) {
+        return renderMultiDevice(devices, dynamic, std::max<size_t>(chunkRows, 1),
+            iterations, gwx, gwy, cr, ci, maxIterations);
+    }
+
+    sycl::platform platform = sycl::platform::get_platforms()[platformIndex];
     sycl::device device = platform.get_devices()[deviceIndex];
+    sycl::context context = sycl::context{ device };
+
+    // With --prebuild, the Julia kernel builds on a background thread while
+    // the host does the rest of its startup work: querying and printing the
+    // device information, creating the queue, and allocating and
+    // initializing the output buffer.  Otherwise, the kernel is compiled
+    // implicitly by the first submission.
+    const auto host_start = test_clock::now();
+    std::future<julia_bundle> building;
+    std::chrono::duration<float> build_seconds{0};
+    if (prebuild) {
+        building = std::async(std::launch::async, [&build_seconds, context, device]() {
+            const auto build_start = test_clock::now();
+            julia_bundle built = buildJulia(context, device);
+            build_seconds = test_clock::now() - build_start;
+            return built;
+        });
+    }
+
+    printf("Running on SYCL platform: %s\n", platform.get_info<sycl::info::platform::name>().c_str());
     printf("Running on SYCL device: %s\n", device.get_info<sycl::info::device::name>().c_str());
+    printf("Device has %u compute units and a maximum work-group size of %zu\n",
+        device.get_info<sycl::info::device::max_compute_units>(),
+        device.get_info<sycl::info::device::max_work_group_size>());
 
-    sycl::context context = sycl::context{ device };
-    sycl::queue queue = sycl::queue{ context, device, sycl::property::queue::in_order() };
+    chrometrace::Tracer tracer{ traceFile };
+    sycl::queue queue = sycl::queue{ context, device, chrometrace::queue_properties(tracer) };
+    chrometrace::Queue traced{ queue, tracer, "Julia Queue" };
+
+    if (!jobsFile.empty()) {
+        std::optional<julia_bundle> bundle;
+        if (prebuild) {
+            bundle = building.get();
+        }
+        int result = renderJobs(traced, bundle, jobsFile, threads);
+        if (!tracer.write()) {
+            fprintf(stderr, "Error: could not write trace file %s\n", traceFile.c_str());
+            result = -1;
+        }
+        return result;
+    }
 
+    // Clearing the buffer on the host touches its pages before the first
+    // render writes it.
     sycl::uchar4* ptr = sycl::malloc<sycl::uchar4>(gwx * gwy, device, context, sycl::usm::alloc::host);
-    float cr = -0.123f;
-    float ci = 0.745f;
+    memset(ptr, 0, gwx * gwy * sizeof(sycl::uchar4));
+    const std::chrono::duration<float> host_seconds = test_clock::now() - host_start;
+
+    std::optional<julia_bundle> bundle;
+    std::chrono::duration<float> overlap_seconds{0};
+    if (prebuild) {
+        bundle = building.get();
+        overlap_seconds = test_clock::now() - host_start;
+    }
+
+    // Renders once and waits, to measure the time from startup to the first
+    // result, including kernel compilation.
+    submitJulia(traced.label("julia first"), bundle, ptr, gwx, gwy, cr, ci, maxIterations);
+    traced.wait();
+    std::chrono::duration<float> first_seconds = test_clock::now() - program_start;
+    if (prebuild) {
+        // Without the overlap, the host work and the kernel build would run
+        // one after the other.
+        const std::chrono::duration<float> serial_seconds =
+            first_seconds - overlap_seconds + host_seconds + build_seconds;
+        printf("Startup host work %f ms, background kernel build %f ms\n",
+            host_seconds.count() * 1e3f, build_seconds.count() * 1e3f);
+        printf("Time to first result: %f ms with overlap, %f ms without overlap\n",
+            first_seconds.count() * 1e3f, serial_seconds.count() * 1e3f);
+    } else {
+        printf("Startup host work %f ms\n", host_seconds.count() * 1e3f);
+        printf("Time to first result: %f ms (kernel built at first submission)\n",
+            first_seconds.count() * 1e3f);
+    }
 
     auto start = test_clock::now();
     for (int i = 0; i < iterations; i++) {
-        queue.parallel_for({gwx, gwy}, Julia(ptr, cr, ci));
+        submitJulia(traced.label("julia"), bundle, ptr, gwx, gwy, cr, ci, maxIterations);
     }
-    queue.wait();
+    auto submitted = test_clock::now();
+    traced.wait();
     auto end = test_clock::now();
     std::chrono::duration<float> elapsed_seconds = end - start;
+    std::chrono::duration<float> eager_submit_seconds = submitted - start;
+    const std::chrono::duration<float> eager_seconds = elapsed_seconds;
     printf("Finished in %f seconds\n", elapsed_seconds.count());
 
-    BMP::save_image(reinterpret_cast<const uint32_t*>(ptr), gwx, gwy, filename);
-    printf("Wrote image file %s\n", filename);
+    if (graph) {
+        // Records the same sequence of launches once, then replays it with a
+        // single submission.  If command graphs are not supported, all
+        // iterations are batched into a single command group instead.
+        bool useGraph = false;
+#if defined(SYCL_EXT_ONEAPI_GRAPH)
+        useGraph = device.has(sycl::aspect::ext_oneapi_limited_graph);
+#endif
+
+        std::chrono::duration<float> record_seconds{0};
+        std::chrono::duration<float> replay_submit_seconds{0};
+        if (useGraph) {
+#if defined(SYCL_EXT_ONEAPI_GRAPH)
+            printf("Replaying launches using a command graph.\n");
+
+            start = test_clock::now();
+            syclex::command_graph recordGraph{context, device};
+            recordGraph.begin_recording(queue);
+            for (int i = 0; i < iterations; i++) {
+                queue.parallel_for({gwy, gwx}, Julia(ptr, cr, ci, maxIterations));
+            }
+            recordGraph.end_recording(queue);
+            auto execGraph = recordGraph.finalize();
+            record_seconds = test_clock::now() - start;
+
+            start = test_clock::now();
+            traced.label("julia graph").submit([&](sycl::handler& cgh) {
+                cgh.ext_oneapi_graph(execGraph);
+            });
+            submitted = test_clock::now();
+            traced.wait();
+            end = test_clock::now();
+#endif
+        } else {
+            printf("Command graphs are not supported, batching launches into one command group.\n");
+
+            const Julia julia(ptr, cr, ci, maxIterations);
+            start = test_clock::now();
+            traced.label("julia batched").parallel_for({gwy, gwx}, [=](sycl::item<2> item) {
+                for (size_t i = 0; i < iterations; i++) {
+                    julia(item);
+                }
+            });
+            submitted = test_clock::now();
+            traced.wait();
+            end = test_clock::now();
+        }
+        elapsed_seconds = end - start;
+        replay_submit_seconds = submitted - start;
+        printf("Replay finished in %f seconds\n", elapsed_seconds.count());
+
+        if (useGraph) {
+            printf("Recorded and finalized graph in %f seconds\n", record_seconds.count());
+        }
+        printf("Host submit overhead per iteration: eager %f us, replay %f us, saved %f us\n",
+            eager_submit_seconds.count() * 1e6f / iterations,
+            replay_submit_seconds.count() * 1e6f / iterations,
+            (eager_submit_seconds - replay_submit_seconds).count() * 1e6f / iterations);
+    }
+
+    if (persistent) {
+        const size_t localSize = tileSize * tileSize;
+        if (groups == 0) {
+            groups = device.get_info<sycl::info::device::max_compute_units>() * 2;
+        }
+        if (localSize > device.get_info<sycl::info::device::max_work_group_size>()) {
+            fprintf(stderr, "Error: tile size %zu exceeds the maximum work-group size\n", tileSize);
+            return -1;
+        }
+        printf("Rendering with %zu persistent work-groups of %zux%zu tiles.\n", groups, tileSize, tileSize);
+
+        unsigned* counter = sycl::malloc_device<unsigned>(1, device, context);
+
+        start = test_clock::now();
+        for (int i = 0; i < iterations; i++) {
+            traced.label("reset tile counter").memset(counter, 0, sizeof(unsigned));
+            traced.label("julia persistent").parallel_for(
+                sycl::nd_range<1>{groups * localSize, localSize},
+                JuliaTiles(ptr, counter, cr, ci, maxIterations, (int)gwx, (int)gwy, (int)tileSize));
+        }
+        traced.wait();
+        end = test_clock::now();
+        std::chrono::duration<float> persistent_seconds = end - start;
+        printf("Persistent finished in %f seconds (%.2fx vs. static)\n",
+            persistent_seconds.count(),
+            eager_seconds.count() / persistent_seconds.count());
+
+        sycl::free(counter, context);
+    }
+
+    if (subgroup) {
+        const size_t localSize = tileSize * tileSize;
+        if (localSize > device.get_info<sycl::info::device::max_work_group_size>()) {
+            fprintf(stderr, "Error: tile size %zu exceeds the maximum work-group size\n", tileSize);
+            return -1;
+        }
+        if (morton && (tileSize & (tileSize - 1))) {
+            fprintf(stderr, "Error: Morton order requires a power of two tile size\n");
+            return -1;
+        }
+        printf("Rendering with sub-group uniform early exit, %zux%zu tiles%s.\n",
+            tileSize, tileSize, morton ? " in Morton order" : "");
+
+        // The SIMD efficiency counters require 64-bit atomics.
+        uint64_t* counters = nullptr;
+        if (device.has(sycl::aspect::atomic64)) {
+            counters = sycl::malloc_shared<uint64_t>(2, device, context);
+            counters[0] = counters[1] = 0;
+        }
+
+        const size_t groupsX = (gwx + tileSize - 1) / tileSize;
+        const size_t groupsY = (gwy + tileSize - 1) / tileSize;
+        start = test_clock::now();
+        for (int i = 0; i < iterations; i++) {
+            const sycl::nd_range<2> ndr{{groupsY * tileSize, groupsX * tileSize}, {tileSize, tileSize}};
+            if (counters) {
+                traced.label("julia sub-group").parallel_for(ndr,
+                    JuliaSubGroup<true>(ptr, counters, cr, ci, maxIterations, (int)gwx, (int)gwy, (int)tileSize, morton));
+            } else {
+                traced.label("julia sub-group").parallel_for(ndr,
+                    JuliaSubGroup<false>(ptr, nullptr, cr, ci, maxIterations, (int)gwx, (int)gwy, (int)tileSize, morton));
+            }
+        }
+        traced.wait();
+        end = test_clock::now();
+        std::chrono::duration<float> subgroup_seconds = end - start;
+        printf("Sub-group finished in %f seconds (%.2fx vs. static)\n",
+            subgroup_seconds.count(),
+            eager_seconds.count() / subgroup_seconds.count());
+
+        if (counters) {
+            printf("SIMD efficiency: %.1f%% (%llu useful / %llu executed lane iterations)\n",
+                counters[1] ? 100.0 * counters[0] / counters[1] : 100.0,
+                (unsigned long long)counters[0], (unsigned long long)counters[1]);
+            sycl::free(counters, context);
+        } else {
+            printf("SIMD efficiency: unavailable, device does not support 64-bit atomics\n");
+        }
+    }
+
+    if (subdivide) {
+        printf("Rendering with Mariani-Silver subdivision.\n");
+        renderSubdivided(queue, ptr, gwx, gwy, cr, ci, maxIterations, eager_seconds, iterations);
+    }
+
+    size_t mismatches = 0;
+    if (periodicity) {
+        printf("Rendering with periodicity checking.\n");
+        mismatches += renderPeriodic(queue, ptr, iterations, gwx, gwy, cr, ci, maxIterations, eager_seconds);
+    }
+
+    if (precision != "float") {
+        if ((precision == "half" && !device.has(sycl::aspect::fp16)) ||
+            (precision == "double" && !device.has(sycl::aspect::fp64))) {
+            fprintf(stderr, "Error: device does not support %s precision\n", precision.c_str());
+            return -1;
+        }
+        printf("Rendering with %s precision.\n", precision.c_str());
+
+        // Keep the float image as the reference and save the new image.
+        sycl::uchar4* reference = ptr;
+        ptr = sycl::malloc<sycl::uchar4>(gwx * gwy, device, context, sycl::usm::alloc::host);
+        if (precision == "half") {
+            renderPrecision<sycl::half>(queue, ptr, reference,
+                iterations, gwx, gwy, cr, ci, maxIterations, eager_seconds);
+        } else {
+            renderPrecision<double>(queue, ptr, reference,
+                iterations, gwx, gwy, cr, ci, maxIterations, eager_seconds);
+        }
+        sycl::free(reference, context);
+    }
+
+    if (samples > 0) {
+        renderAdaptive(queue, ptr, iterations, gwx, gwy, cr, ci, maxIterations, samples, threshold);
+    }
+
+    std::uint8_t* indices = nullptr;
+    std::vector<uint32_t> palette;
+    if (indexed) {
+        printf("Rendering palette indices.\n");
+
+        indices = sycl::malloc<std::uint8_t>(gwx * gwy, device, context, sycl::usm::alloc::host);
+        palette = juliaPalette(maxIterations);
+
+        start = test_clock::now();
+        for (int i = 0; i < iterations; i++) {
+            traced.label("julia indexed").parallel_for({gwy, gwx}, JuliaIndexed(indices, cr, ci, maxIterations));
+        }
+        traced.wait();
+        end = test_clock::now();
+        std::chrono::duration<float> indexed_seconds = end - start;
+        printf("Indexed finished in %f seconds (%.2fx vs. static), %zu bytes vs. %zu bytes per image\n",
+            indexed_seconds.count(),
+            eager_seconds.count() / indexed_seconds.count(),
+            gwx * gwy * sizeof(std::uint8_t), gwx * gwy * sizeof(sycl::uchar4));
+    }
+
+    saveImages(queue, ptr, gwx, gwy, format, threads, deviceFilter, indices, palette.data());
+
+    if (mapped) {
+        // For comparison, render once into scratch host USM and save the
+        // image.  This writes a separate file, so the saved image and the
+        // image compared against the golden image are not replaced.
+        sycl::uchar4* scratch = sycl::malloc<sycl::uchar4>(gwx * gwy, device, context, sycl::usm::alloc::host);
+        start = test_clock::now();
+        queue.parallel_for({gwy, gwx}, Julia(scratch, cr, ci, maxIterations)).wait();
+        BMP::save_image(reinterpret_cast<const uint32_t*>(scratch), gwx, gwy, mappedFilename);
+        end = test_clock::now();
+        std::chrono::duration<float> save_seconds = end - start;
+        sycl::free(scratch, context);
+
+        // If the device can access system allocations, render directly into
+        // the mapped file.  Otherwise, render into device memory and copy
+        // into the mapped file, which avoids the host copy in save_image.
+        start = test_clock::now();
+        BMP::MappedImage image;
+        if (!BMP::map_image(gwx, gwy, mappedFilename, image)) {
+            fprintf(stderr, "Error: could not map image file %s\n", mappedFilename);
+            return -1;
+        }
+        sycl::uchar4* dst = reinterpret_cast<sycl::uchar4*>(image.pixels);
+        if (device.has(sycl::aspect::usm_system_allocations)) {
+            printf("Rendering directly into the mapped image file.\n");
+            traced.label("julia mapped").parallel_for({gwy, gwx}, Julia(dst, cr, ci, maxIterations)).wait();
+        } else {
+            printf("Rendering into device memory and copying into the mapped image file.\n");
+            const size_t bytes = gwx * gwy * sizeof(sycl::uchar4);
+            sycl::uchar4* tmp = sycl::malloc_device<sycl::uchar4>(gwx * gwy, device, context);
+#if defined(SYCL_EXT_ONEAPI_COPY_OPTIMIZE)
+            syclex::prepare_for_device_copy(dst, bytes, context);
+#endif
+            traced.label("julia device").parallel_for({gwy, gwx}, Julia(tmp, cr, ci, maxIterations));
+            traced.label("copy to mapped").memcpy(dst, tmp, bytes).wait();
+#if defined(SYCL_EXT_ONEAPI_COPY_OPTIMIZE)
+            syclex::release_from_device_copy(dst, context);
+#endif
+            sycl::free(tmp, context);
+        }
+        BMP::unmap_image(image);
+        end = test_clock::now();
+        std::chrono::duration<float> mapped_seconds = end - start;
+        printf("Rendered and wrote image file %s in %f seconds mapped vs. %f seconds saved\n",
+            mappedFilename, mapped_seconds.count(), save_seconds.count());
+    }
+
+    int result = mismatches ? -1 : 0;
+    if (!saveGolden.empty()) {
+        // This is the same image that --golden compares against.
+        if (BMP::save_image(reinterpret_cast<const uint32_t*>(ptr), gwx, gwy, saveGolden.c_str())) {
+            printf("Wrote golden image file %s\n", saveGolden.c_str());
+        } else {
+            fprintf(stderr, "Error: could not write golden image file %s\n", saveGolden.c_str());
+            result = -1;
+        }
+    }
+    if (!golden.empty()) {
+        std::vector<uint32_t> reference;
+        size_t width = 0, height = 0;
+        if (!BMP::load_image(golden.c_str(), reference, width, height)) {
+            fprintf(stderr, "Error: could not read golden image file %s\n", golden.c_str());
+            result = -1;
+        } else if (width != gwx || height != gwy) {
+            fprintf(stderr, "Error: golden image is %zux%zu, rendered image is %zux%zu\n",
+                width, height, gwx, gwy);
+            result = -1;
+        } else {
+            sycl::uchar4* diff = sycl::malloc<sycl::uchar4>(gwx * gwy, device, context, sycl::usm::alloc::host);
+            double psnr = diffImages(queue, ptr, reference, diff);
+            if (psnr < minPSNR) {
+                BMP::save_image(reinterpret_cast<const uint32_t*>(diff), gwx, gwy, diffFilename);
+                fprintf(stderr, "Error: image does not match golden image %s, wrote difference to %s\n",
+                    golden.c_str(), diffFilename);
+                result = -1;
+            } else {
+                printf("Image matches golden image %s.\n", golden.c_str());
+            }
+            sycl::free(diff, context);
+        }
+    }
+
+    if (tracer.enabled()) {
+        if (tracer.write()) {
+            printf("Wrote trace file %s\n", traceFile.c_str());
+        } else {
+            fprintf(stderr, "Error: could not write trace file %s\n", traceFile.c_str());
+            result = -1;
+        }
+    }
+
+    sycl::free(indices, context);
+    sycl::free(ptr, context);
 
     printf("... done!\n");
 
-    return 0;
+    return result;
 }
@@ -0,0 +1,411 @@
+/*
+// Copyright (c) 2019-2026 Ben Ashbaugh
+//
+// SPDX-License-Identifier: MIT
+*/
+
+#pragma once
+#include <algorithm>
+#include <fstream>
+#include <thread>
+#include <vector>
+#include <stdint.h>
+#include <string.h>
+
+namespace PNG
+{
+
+// Notes:
+//  * Images are written as 24bpp RGB PNG files with 8 bits per channel.
+//  * Image data is compressed with a simple deflate encoder that uses LZ77
+//    matching and the fixed Huffman codes, so no compression library is
+//    required.
+//  * Row strips are filtered and compressed in parallel.  Each strip is an
+//    independent sequence of deflate blocks that ends on a byte boundary
+//    with an empty stored block, so the strips can simply be concatenated.
+
+static const uint16_t length_base[29] = {
+    3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+    35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258 };
+static const uint8_t length_extra[29] = {
+    0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2,
+    3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0 };
+static const uint16_t dist_base[30] = {
+    1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193,
+    257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577 };
+static const uint8_t dist_extra[30] = {
+    0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6,
+    7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13 };
+
+static uint32_t crc32(uint32_t crc, const uint8_t* data, size_t len)
+{
+    static const std::vector<uint32_t> table = [] {
+        std::vector<uint32_t> t(256);
+        for (uint32_t n = 0; n < 256; n++) {
+            uint32_t c = n;
+            for (int k = 0; k < 8; k++) {
+                c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+            }
+            t[n] = c;
+        }
+        return t;
+    }();
+
+    crc = ~crc;
+    for (size_t i = 0; i < len; i++) {
+        crc = table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+    }
+    return ~crc;
+}
+
+static const uint32_t adler_base = 65521;
+
+static uint32_t adler32(uint32_t adler, const uint8_t* data, size_t len)
+{
+    uint32_t s1 = adler & 0xFFFF;
+    uint32_t s2 = adler >> 16;
+    while (len) {
+        // 5552 is the largest block that cannot overflow s2.
+        size_t block = std::min<size_t>(len, 5552);
+        len -= block;
+        while (block--) {
+            s1 += *data++;
+            s2 += s1;
+        }
+        s1 %= adler_base;
+        s2 %= adler_base;
+    }
+    return (s2 << 16) | s1;
+}
+
+// Combines the Adler-32 checksums of two consecutive blocks of data, given
+// the length of the second block.
+static uint32_t adler32_combine(uint32_t adler1, uint32_t adler2, size_t len2)
+{
+    uint32_t rem = static_cast<uint32_t>(len2 % adler_base);
+    uint32_t sum1 = adler1 & 0xFFFF;
+    uint32_t sum2 = static_cast<uint32_t>((uint64_t)rem * sum1 % adler_base);
+    sum1 += (adler2 & 0xFFFF) + adler_base - 1;
+    sum2 += (adler1 >> 16) + (adler2 >> 16) + adler_base - rem;
+    if (sum1 >= adler_base) sum1 -= adler_base;
+    if (sum1 >= adler_base) sum1 -= adler_base;
+    if (sum2 >= (adler_base << 1)) sum2 -= (adler_base << 1);
+    if (sum2 >= adler_base) sum2 -= adler_base;
+    return (sum2 << 16) | sum1;
+}
+
+// The PNG Paeth predictor.  This is usable from host and device code.
+static inline int paeth_predictor(int a, int b, int c)
+{
+    int p = a + b - c;
+    int pa = p > a ? p - a : a - p;
+    int pb = p > b ? p - b : b - p;
+    int pc = p > c ? p - c : c - p;
+    if (pa <= pb && pa <= pc) return a;
+    if (pb <= pc) return b;
+    return c;
+}
+
+class BitWriter {
+public:
+    explicit BitWriter(std::vector<uint8_t>& _out) : out(_out) {}
+
+    // Writes bits least significant bit first.
+    void put(uint32_t bits, int count) {
+        buffer |= (uint64_t)bits << used;
+        used += count;
+        while (used >= 8) {
+            out.push_back(static_cast<uint8_t>(buffer));
+            buffer >>= 8;
+            used -= 8;
+        }
+    }
+
+    // Huffman codes are written most significant bit first.
+    void put_code(uint32_t code, int count) {
+        uint32_t reversed = 0;
+        for (int i = 0; i < count; i++) {
+            reversed = (reversed << 1) | ((code >> i) & 1);
+        }
+        put(reversed, count);
+    }
+
+    void align() {
+        if (used) {
+            out.push_back(static_cast<uint8_t>(buffer));
+            buffer = 0;
+            used = 0;
+        }
+    }
+
+private:
+    std::vector<uint8_t>& out;
+    uint64_t buffer = 0;
+    int used = 0;
+};
+
+static void put_literal(BitWriter& bw, int value)
+{
+    if (value < 144)      bw.put_code(0x30 + value, 8);
+    else if (value < 256) bw.put_code(0x190 + value - 144, 9);
+    else if (value < 280) bw.put_code(value - 256, 7);
+    else                  bw.put_code(0xC0 + value - 280, 8);
+}
+
+static void put_match(BitWriter& bw, size_t length, size_t distance)
+{
+    int lc = 28;
+    while (length_base[lc] > length) lc--;
+    put_literal(bw, 257 + lc);
+    bw.put(static_cast<uint32_t>(length - length_base[lc]), length_extra[lc]);
+
+    int dc = 29;
+    while (dist_base[dc] > distance) dc--;
+    bw.put_code(dc, 5);
+    bw.put(static_cast<uint32_t>(distance - dist_base[dc]), dist_extra[dc]);
+}
+
+// Compresses data as a non-final fixed Huffman deflate block followed by an
+// empty stored block, so the output ends on a byte boundary.
+static void deflate_strip(const uint8_t* data, size_t len, std::vector<uint8_t>& out)
+{
+    const int hash_bits = 15;
+    const size_t window = 32768;
+    const int max_chain = 32;
+    const size_t min_match = 3;
+    const size_t max_match = 258;
+
+    std::vector<int64_t> head(size_t(1) << hash_bits, -1);
+    std::vector<int64_t> prev(window, -1);
+
+    auto hash = [&](size_t p) {
+        return ((data[p] << 10) ^ (data[p + 1] << 5) ^ data[p + 2]) & ((1 << hash_bits) - 1);
+    };
+    auto insert = [&](size_t p) {
+        if (p + min_match <= len) {
+            uint32_t h = hash(p);
+            prev[p & (window - 1)] = head[h];
+            head[h] = static_cast<int64_t>(p);
+        }
+    };
+
+    BitWriter bw(out);
+    bw.put(0, 1);   // BFINAL = 0
+    bw.put(1, 2);   // BTYPE = 01, fixed Huffman codes
+
+    size_t i = 0;
+    while (i < len) {
+        size_t best_len = 0;
+        size_t best_dist = 0;
+        if (i + min_match <= len) {
+            const size_t max_len = std::min(max_match, len - i);
+            int64_t cand = head[hash(i)];
+            for (int chain = 0; cand >= 0 && i - cand <= window && chain < max_chain; chain++) {
+                const uint8_t* a = data + cand;
+                const uint8_t* b = data + i;
+                if (a[best_len] == b[best_len]) {
+                    size_t l = 0;
+                    while (l < max_len && a[l] == b[l]) l++;
+                    if (l > best_len) {
+                        best_len = l;
+                        best_dist = i - cand;
+                        if (l == max_len) break;
+                    }
+                }
+                cand = prev[cand & (window - 1)];
+            }
+        }
+
+        if (best_len >= min_match) {
+            put_match(bw, best_len, best_dist);
+            for (size_t k = 0; k < best_len; k++) {
+                insert(i + k);
+            }
+            i += best_len;
+        } else {
+            put_literal(bw, data[i]);
+            insert(i);
+            i++;
+        }
+    }
+    put_literal(bw, 256);   // end of block
+
+    bw.put(0, 1);   // BFINAL = 0
+    bw.put(0, 2);   // BTYPE = 00, stored
+    bw.align();
+    const uint8_t stored[4] = { 0x00, 0x00, 0xFF, 0xFF };
+    out.insert(out.end(), stored, stored + 4);
+}
+
+// Converts one row of BGRA pixels to RGB bytes.
+static void convert_row(const uint32_t* src, size_t width, uint8_t* dst)
+{
+    const uint8_t* p = reinterpret_cast<const uint8_t*>(src);
+    for (size_t x = 0; x < width; x++) {
+        dst[x * 3 + 0] = p[x * 4 + 2];
+        dst[x * 3 + 1] = p[x * 4 + 1];
+        dst[x * 3 + 2] = p[x * 4 + 0];
+    }
+}
+
+// Filters one row of RGB bytes, choosing the filter type that minimizes the
+// sum of absolute differences.  The output is the filter type byte followed
+// by the filtered row.
+static void filter_row(const uint8_t* row, const uint8_t* prior, size_t row_bytes, uint8_t* dst)
+{
+    const size_t bpp = 3;
+    std::vector<uint8_t> candidate(row_bytes);
+    uint64_t best_sum = UINT64_MAX;
+    for (uint8_t type = 0; type < 5; type++) {
+        uint64_t sum = 0;
+        for (size_t i = 0; i < row_bytes; i++) {
+            int a = i >= bpp ? row[i - bpp] : 0;
+            int b = prior ? prior[i] : 0;
+            int c = (i >= bpp && prior) ? prior[i - bpp] : 0;
+            int pred = 0;
+            switch (type) {
+            case 1: pred = a; break;
+            case 2: pred = b; break;
+            case 3: pred = (a + b) / 2; break;
+            case 4: pred = paeth_predictor(a, b, c); break;
+            }
+            uint8_t v = static_cast<uint8_t>(row[i] - pred);
+            candidate[i] = v;
+            sum += v < 128 ? v : 256 - v;
+        }
+        if (sum < best_sum) {
+            best_sum = sum;
+            dst[0] = type;
+            memcpy(dst + 1, candidate.data(), row_bytes);
+        }
+    }
+}
+
+static void write_chunk(std::ofstream& os, const char* type, const uint8_t* data, size_t len)
+{
+    const uint8_t header[8] = {
+        static_cast<uint8_t>(len >> 24), static_cast<uint8_t>(len >> 16),
+        static_cast<uint8_t>(len >> 8), static_cast<uint8_t>(len),
+        static_cast<uint8_t>(type[0]), static_cast<uint8_t>(type[1]),
+        static_cast<uint8_t>(type[2]), static_cast<uint8_t>(type[3]) };
+    uint32_t crc = crc32(0, header + 4, 4);
+    crc = crc32(crc, data, len);
+    const uint8_t trailer[4] = {
+        static_cast<uint8_t>(crc >> 24), static_cast<uint8_t>(crc >> 16),
+        static_cast<uint8_t>(crc >> 8), static_cast<uint8_t>(crc) };
+    os.write(reinterpret_cast<const char*>(header), sizeof(header));
+    os.write(reinterpret_cast<const char*>(data), len);
+    os.write(reinterpret_cast<const char*>(trailer), sizeof(trailer));
+}
+
+// Writes four channel BGRA uint32_t data as a 24bpp RGB PNG file.
+// Rows are compressed in parallel using the specified number of threads, or
+// one thread per hardware thread if zero.  If filtered is not null, it
+// contains already filtered rows, each consisting of a filter type byte
+// followed by width * 3 filtered bytes.
+static bool save_image(
+    const uint32_t *ptr, size_t width, size_t height,
+    const char *file_name,
+    unsigned threads = 0,
+    const uint8_t *filtered = nullptr)
+{
+    std::ofstream os(file_name, std::ios::binary);
+    if (!os.good())
+        return false;
+
+    const size_t row_bytes = width * 3;
+    const size_t filtered_row_bytes = row_bytes + 1;
+
+    if (threads == 0) {
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    const size_t strips = std::max<size_t>(1, std::min<size_t>(threads, height));
+    const size_t rows_per_strip = (height + strips - 1) / strips;
+
+    std::vector<std::vector<uint8_t>> compressed(strips);
+    std::vector<uint32_t> adlers(strips, 1);
+    std::vector<size_t> lengths(strips, 0);
+
+    auto compress = [&](size_t s) {
+        const size_t row_start = std::min(height, s * rows_per_strip);
+        const size_t row_end = std::min(height, row_start + rows_per_strip);
+        const size_t len = (row_end - row_start) * filtered_row_bytes;
+
+        std::vector<uint8_t> scratch;
+        const uint8_t* data = nullptr;
+        if (filtered) {
+            data = filtered + row_start * filtered_row_bytes;
+        } else {
+            scratch.resize(len);
+            std::vector<uint8_t> row(row_bytes), prior(row_bytes);
+            if (row_start > 0) {
+                convert_row(ptr + (row_start - 1) * width, width, prior.data());
+            }
+            for (size_t y = row_start; y < row_end; y++) {
+                convert_row(ptr + y * width, width, row.data());
+                filter_row(row.data(), y > 0 ? prior.data() : nullptr, row_bytes,
+                    scratch.data() + (y - row_start) * filtered_row_bytes);
+                std::swap(row, prior);
+            }
+            data = scratch.data();
+        }
+
+        adlers[s] = adler32(1, data, len);
+        lengths[s] = len;
+        deflate_strip(data, len, compressed[s]);
+    };
+
+    std::vector<std::thread> workers;
+    for (size_t s = 1; s < strips; s++) {
+        workers.emplace_back(compress, s);
+    }
+    compress(0);
+    for (auto& w : workers) {
+        w.join();
+    }
+
+    uint32_t adler = adlers[0];
+    for (size_t s = 1; s < strips; s++) {
+        adler = adler32_combine(adler, adlers[s], lengths[s]);
+    }
+
+    const uint8_t signature[8] = { 0x89, 'P', 'N', 'G', 0x0D, 0x0A, 0x1A, 0x0A };
+    os.write(reinterpret_cast<const char*>(signature), sizeof(signature));
+
+    const uint8_t ihdr[13] = {
+        static_cast<uint8_t>(width >> 24), static_cast<uint8_t>(width >> 16),
+        static_cast<uint8_t>(width >> 8), static_cast<uint8_t>(width),
+        static_cast<uint8_t>(height >> 24), static_cast<uint8_t>(height >> 16),
+        static_cast<uint8_t>(height >> 8), static_cast<uint8_t>(height),
+        8,  // bit depth
+        2,  // color type: RGB
+        0,  // compression method: deflate
+        0,  // filter method: adaptive
+        0,  // interlace method: none
+    };
+    write_chunk(os, "IHDR", ihdr, sizeof(ihdr));
+
+    // zlib header: deflate with a 32KB window, no preset dictionary.
+    const uint8_t zlib_header[2] = { 0x78, 0x01 };
+    compressed.front().insert(compressed.front().begin(), zlib_header, zlib_header + 2);
+
+    // An empty final fixed Huffman block, then the Adler-32 checksum.
+    const uint8_t zlib_trailer[6] = {
+        0x03, 0x00,
+        static_cast<uint8_t>(adler >> 24), static_cast<uint8_t>(adler >> 16),
+        static_cast<uint8_t>(adler >> 8), static_cast<uint8_t>(adler) };
+    compressed.back().insert(compressed.back().end(), zlib_trailer, zlib_trailer + 6);
+
+    const size_t max_chunk = size_t(1) << 30;
+    for (const auto& c : compressed) {
+        for (size_t offset = 0; offset < c.size(); offset += max_chunk) {
+            write_chunk(os, "IDAT", c.data() + offset, std::min(max_chunk, c.size() - offset));
+        }
+    }
+
+    write_chunk(os, "IEND", nullptr, 0);
+
+    return os.good();
+}
+
+}
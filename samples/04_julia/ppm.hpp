@@ -0,0 +1,45 @@
+/*
+// Copyright (c) 2019-2026 Ben Ashbaugh
+//
+// SPDX-License-Identifier: MIT
+*/
+
+#pragma once
+#include <fstream>
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+namespace PPM
+{
+
+// Writes four channel BGRA uint32_t data as a binary (P6) RGB PPM file.
+// There is no compression and no row padding, and rows are written top to
+// bottom one row at a time, so this is the fastest format to write.
+static bool save_image(
+    const uint32_t *ptr, size_t width, size_t height,
+    const char *file_name)
+{
+    std::ofstream os(file_name, std::ios::binary);
+    if (!os.good())
+        return false;
+
+    const std::string header =
+        "P6\n" + std::to_string(width) + " " + std::to_string(height) + "\n255\n";
+    os.write(header.data(), header.size());
+
+    std::vector<uint8_t> row(width * 3);
+    for (size_t y = 0; y < height; y++) {
+        const uint8_t* p = reinterpret_cast<const uint8_t*>(ptr + y * width);
+        for (size_t x = 0; x < width; x++) {
+            row[x * 3 + 0] = p[x * 4 + 2];
+            row[x * 3 + 1] = p[x * 4 + 1];
+            row[x * 3 + 2] = p[x * 4 + 0];
+        }
+        os.write(reinterpret_cast<const char*>(row.data()), row.size());
+    }
+
+    return os.good();
+}
+
+}
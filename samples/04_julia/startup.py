@@ -0,0 +1,98 @@
+#!/usr/bin/env python3
+
+# Copyright (c) 2026 Ben Ashbaugh
+#
+# SPDX-License-Identifier: MIT
+
+"""Measures the startup time of the julia sample.
+
+Each configuration runs julia several times as a new process and reports
+the median wall time from process start to process exit, and the median
+time to first result reported by julia, which runs from the start of main
+until the first image is complete, including kernel compilation.
+
+Configurations:
+  no cache    the runtime's in-memory cache only, so every run compiles
+  cold cache  the persistent device code cache in a new, empty directory
+  warm cache  the persistent device code cache, after it is populated
+  AOT         a julia binary compiled ahead-of-time, if one is given
+"""
+
+import argparse
+import os
+import re
+import shutil
+import statistics
+import subprocess
+import sys
+import tempfile
+import time
+
+FIRST_RESULT = re.compile(r"Time to first result: ([0-9.]+) ms")
+
+
+def run(exe, args, cwd, env):
+    start = time.perf_counter()
+    proc = subprocess.run([exe] + args, cwd=cwd, env=env,
+                          stdout=subprocess.PIPE, stderr=subprocess.STDOUT,
+                          universal_newlines=True)
+    wall = (time.perf_counter() - start) * 1e3
+    if proc.returncode != 0:
+        sys.exit("Error: %s failed:\n%s" % (exe, proc.stdout))
+    match = FIRST_RESULT.search(proc.stdout)
+    if not match:
+        sys.exit("Error: %s did not report the time to first result" % exe)
+    return wall, float(match.group(1))
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Measures julia startup time.")
+    parser.add_argument("--julia", required=True, help="julia executable")
+    parser.add_argument("--aot", help="julia executable compiled ahead-of-time")
+    parser.add_argument("--runs", type=int, default=5, help="runs per configuration")
+    parser.add_argument("args", nargs=argparse.REMAINDER,
+                        help="additional julia arguments, after --")
+    options = parser.parse_args()
+
+    extra = [a for a in options.args if a != "--"]
+    args = ["-i", "1", "--gwx", "256", "--gwy", "256"] + extra
+
+    # Ignore any cache settings from the environment.
+    env = dict(os.environ)
+    env.pop("SYCL_CACHE_PERSISTENT", None)
+    env.pop("SYCL_CACHE_DIR", None)
+
+    work = tempfile.mkdtemp(prefix="julia_startup_")
+    try:
+        configs = []
+
+        configs.append(("no cache",
+            [run(options.julia, args, work, env) for _ in range(options.runs)]))
+
+        cold = []
+        for r in range(options.runs):
+            cache = os.path.join(work, "cold%d" % r)
+            cold.append(run(options.julia, args + ["--cache-dir", cache], work, env))
+        configs.append(("cold cache", cold))
+
+        cache = os.path.join(work, "warm")
+        run(options.julia, args + ["--cache-dir", cache], work, env)
+        configs.append(("warm cache",
+            [run(options.julia, args + ["--cache-dir", cache], work, env) for _ in range(options.runs)]))
+
+        if options.aot:
+            configs.append(("AOT",
+                [run(options.aot, args, work, env) for _ in range(options.runs)]))
+    finally:
+        shutil.rmtree(work, ignore_errors=True)
+
+    print("Median of %d runs:" % options.runs)
+    print("%-12s %16s %20s" % ("", "Process (ms)", "First Result (ms)"))
+    for name, results in configs:
+        print("%-12s %16.1f %20.1f" % (name,
+            statistics.median(r[0] for r in results),
+            statistics.median(r[1] for r in results)))
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,427 @@
+/*
+// Copyright (c) 2026 Ben Ashbaugh
+//
+// SPDX-License-Identifier: MIT
+*/
+
+#include <sycl/sycl.hpp>
+#include <popl/popl.hpp>
+
+#include <stdio.h>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <functional>
+#include <string>
+#include <vector>
+
+using test_clock = std::chrono::high_resolution_clock;
+
+// All kernels compute C = A * B for square row-major n x n matrices.  The
+// matrix size does not need to be a multiple of the tile size: tiles are
+// padded with zeros at the edges of the matrices.
+//
+// The matrices may be float or sycl::half.  Products are always accumulated
+// in float, as is usual for half precision matrix multiplication, since
+// half does not have enough precision to accumulate long dot products.
+
+// One work-item per element of C, reading A and B directly from global
+// memory.
+template <typename T>
+class GemmNaive {
+public:
+    GemmNaive(const T* _a, const T* _b, T* _c, int _n) :
+        a(_a), b(_b), c(_c), n(_n) {}
+    void operator()(sycl::item<2> item) const {
+        const int row = item.get_id(0);
+        const int col = item.get_id(1);
+
+        float sum = 0.0f;
+        for (int k = 0; k < n; k++) {
+            sum += static_cast<float>(a[row * n + k]) * static_cast<float>(b[k * n + col]);
+        }
+        c[row * n + col] = T(sum);
+    }
+private:
+    const T* a;
+    const T* b;
+    T* c;
+    int n;
+};
+
+// One work-item per element of C, with TS x TS work-groups.  Each
+// work-group stages TS x TS tiles of A and B in local memory, so each
+// element of A and B is read from global memory n / TS times rather than n
+// times.
+template <typename T, int TS>
+class GemmTiled {
+public:
+    GemmTiled(const T* _a, const T* _b, T* _c, int _n,
+        sycl::local_accessor<T, 1> _as, sycl::local_accessor<T, 1> _bs) :
+        a(_a), b(_b), c(_c), n(_n), as(_as), bs(_bs) {}
+    void operator()(sycl::nd_item<2> item) const {
+        const int ty = item.get_local_id(0);
+        const int tx = item.get_local_id(1);
+        const int row = item.get_global_id(0);
+        const int col = item.get_global_id(1);
+
+        float sum = 0.0f;
+        for (int k0 = 0; k0 < n; k0 += TS) {
+            as[ty * TS + tx] = (row < n && k0 + tx < n) ? a[row * n + k0 + tx] : T(0);
+            bs[ty * TS + tx] = (k0 + ty < n && col < n) ? b[(k0 + ty) * n + col] : T(0);
+            sycl::group_barrier(item.get_group());
+
+            for (int k = 0; k < TS; k++) {
+                sum += static_cast<float>(as[ty * TS + k]) * static_cast<float>(bs[k * TS + tx]);
+            }
+            sycl::group_barrier(item.get_group());
+        }
+        if (row < n && col < n) {
+            c[row * n + col] = T(sum);
+        }
+    }
+private:
+    const T* a;
+    const T* b;
+    T* c;
+    int n;
+    sycl::local_accessor<T, 1> as;
+    sycl::local_accessor<T, 1> bs;
+};
+
+// As above, but each work-item computes an RB x RB block of C, so work-groups
+// are (TS / RB) x (TS / RB).  The elements of a block are strided by TS / RB
+// so neighboring work-items access neighboring elements.  Each value read
+// from local memory is reused RB times from registers.
+template <typename T, int TS, int RB>
+class GemmBlocked {
+public:
+    static constexpr int L = TS / RB;
+
+    GemmBlocked(const T* _a, const T* _b, T* _c, int _n,
+        sycl::local_accessor<T, 1> _as, sycl::local_accessor<T, 1> _bs) :
+        a(_a), b(_b), c(_c), n(_n), as(_as), bs(_bs) {}
+    void operator()(sycl::nd_item<2> item) const {
+        const int ty = item.get_local_id(0);
+        const int tx = item.get_local_id(1);
+        const int row0 = item.get_group(0) * TS;
+        const int col0 = item.get_group(1) * TS;
+
+        float sum[RB][RB];
+        for (int i = 0; i < RB; i++) {
+            for (int j = 0; j < RB; j++) {
+                sum[i][j] = 0.0f;
+            }
+        }
+
+        for (int k0 = 0; k0 < n; k0 += TS) {
+            for (int i = 0; i < RB; i++) {
+                for (int j = 0; j < RB; j++) {
+                    const int r = ty + i * L;
+                    const int x = tx + j * L;
+                    as[r * TS + x] = (row0 + r < n && k0 + x < n) ? a[(row0 + r) * n + k0 + x] : T(0);
+                    bs[r * TS + x] = (k0 + r < n && col0 + x < n) ? b[(k0 + r) * n + col0 + x] : T(0);
+                }
+            }
+            sycl::group_barrier(item.get_group());
+
+            for (int k = 0; k < TS; k++) {
+                float av[RB];
+                float bv[RB];
+                for (int i = 0; i < RB; i++) {
+                    av[i] = as[(ty + i * L) * TS + k];
+                    bv[i] = bs[k * TS + tx + i * L];
+                }
+                for (int i = 0; i < RB; i++) {
+                    for (int j = 0; j < RB; j++) {
+                        sum[i][j] += av[i] * bv[j];
+                    }
+                }
+            }
+            sycl::group_barrier(item.get_group());
+        }
+
+        for (int i = 0; i < RB; i++) {
+            for (int j = 0; j < RB; j++) {
+                const int row = row0 + ty + i * L;
+                const int col = col0 + tx + j * L;
+                if (row < n && col < n) {
+                    c[row * n + col] = T(sum[i][j]);
+                }
+            }
+        }
+    }
+private:
+    const T* a;
+    const T* b;
+    T* c;
+    int n;
+    sycl::local_accessor<T, 1> as;
+    sycl::local_accessor<T, 1> bs;
+};
+
+// A kernel configuration that may be chosen by the auto-tuner.
+template <typename T>
+struct Config {
+    std::string name;
+    size_t workGroupSize;
+    size_t localMemSize;
+    std::function<void(sycl::queue&, const T*, const T*, T*, size_t)> run;
+};
+
+template <typename T>
+static Config<T> naive()
+{
+    return Config<T>{ "naive", 1, 0,
+        [](sycl::queue& q, const T* a, const T* b, T* c, size_t n) {
+            q.parallel_for(sycl::range<2>{n, n}, GemmNaive<T>(a, b, c, (int)n));
+        } };
+}
+
+template <typename T, int TS>
+static Config<T> tiled()
+{
+    return Config<T>{ "tiled " + std::to_string(TS) + "x" + std::to_string(TS),
+        TS * TS, 2 * TS * TS * sizeof(T),
+        [](sycl::queue& q, const T* a, const T* b, T* c, size_t n) {
+            const size_t global = (n + TS - 1) / TS * TS;
+            q.submit([&](sycl::handler& cgh) {
+                sycl::local_accessor<T, 1> as{ sycl::range<1>{TS * TS}, cgh };
+                sycl::local_accessor<T, 1> bs{ sycl::range<1>{TS * TS}, cgh };
+                cgh.parallel_for(sycl::nd_range<2>{{global, global}, {TS, TS}},
+                    GemmTiled<T, TS>(a, b, c, (int)n, as, bs));
+            });
+        } };
+}
+
+template <typename T, int TS, int RB>
+static Config<T> blocked()
+{
+    static_assert(TS % RB == 0, "the tile size must be a multiple of the block size");
+    constexpr size_t L = TS / RB;
+    return Config<T>{ "blocked " + std::to_string(TS) + "x" + std::to_string(TS) +
+        " / " + std::to_string(RB) + "x" + std::to_string(RB),
+        L * L, 2 * TS * TS * sizeof(T),
+        [](sycl::queue& q, const T* a, const T* b, T* c, size_t n) {
+            const size_t groups = (n + TS - 1) / TS;
+            q.submit([&](sycl::handler& cgh) {
+                sycl::local_accessor<T, 1> as{ sycl::range<1>{TS * TS}, cgh };
+                sycl::local_accessor<T, 1> bs{ sycl::range<1>{TS * TS}, cgh };
+                cgh.parallel_for(sycl::nd_range<2>{{groups * L, groups * L}, {L, L}},
+                    GemmBlocked<T, TS, RB>(a, b, c, (int)n, as, bs));
+            });
+        } };
+}
+
+// Values are multiples of 0.5 between -1 and 1, so they are exactly
+// representable as half, and the float sums of their products are exact.
+static float valueA(size_t row, size_t col)
+{
+    return (int)((row * 3 + col * 2) % 5) * 0.5f - 1.0f;
+}
+
+static float valueB(size_t row, size_t col)
+{
+    return (int)((row * 2 + col * 3) % 5) * 0.5f - 1.0f;
+}
+
+static double seconds(const std::function<void()>& f)
+{
+    auto start = test_clock::now();
+    f();
+    std::chrono::duration<double> elapsed_seconds = test_clock::now() - start;
+    return elapsed_seconds.count();
+}
+
+template <typename T>
+static size_t check(const std::vector<T>& c, const std::vector<float>& reference,
+    const char* type, const std::string& name, float tolerance)
+{
+    size_t mismatches = 0;
+    for (size_t i = 0; i < reference.size(); i++) {
+        const float got = static_cast<float>(c[i]);
+        if (std::fabs(got - reference[i]) > tolerance * (1.0f + std::fabs(reference[i]))) {
+            if (mismatches < 16) {
+                fprintf(stderr, "MisMatch!  %s %s: c[%zu] == %f, want %f\n",
+                    type, name.c_str(), i, got, reference[i]);
+            }
+            mismatches++;
+        }
+    }
+    return mismatches;
+}
+
+// Auto-tunes each family of kernels by timing one run of each configuration
+// that fits on the device, then benchmarks the fastest configuration in
+// each family.
+template <typename T>
+static size_t runType(sycl::queue& queue, const char* type, size_t n, size_t iterations,
+    double peak, float tolerance, bool verbose, const std::vector<float>& reference)
+{
+    const sycl::device device = queue.get_device();
+    const size_t maxWorkGroupSize = device.get_info<sycl::info::device::max_work_group_size>();
+    const size_t localMemSize = device.get_info<sycl::info::device::local_mem_size>();
+
+    const std::vector<std::vector<Config<T>>> families = {
+        { naive<T>() },
+        { tiled<T, 8>(), tiled<T, 16>(), tiled<T, 32>() },
+        { blocked<T, 32, 2>(), blocked<T, 32, 4>(), blocked<T, 64, 4>(), blocked<T, 64, 8>(), blocked<T, 128, 8>() },
+    };
+
+    std::vector<T> h_a(n * n), h_b(n * n), h_c(n * n);
+    for (size_t row = 0; row < n; row++) {
+        for (size_t col = 0; col < n; col++) {
+            h_a[row * n + col] = T(valueA(row, col));
+            h_b[row * n + col] = T(valueB(row, col));
+        }
+    }
+
+    T* a = sycl::malloc_device<T>(n * n, queue);
+    T* b = sycl::malloc_device<T>(n * n, queue);
+    T* c = sycl::malloc_device<T>(n * n, queue);
+    queue.memcpy(a, h_a.data(), n * n * sizeof(T));
+    queue.memcpy(b, h_b.data(), n * n * sizeof(T));
+    queue.wait();
+
+    const double flops = 2.0 * n * n * n;
+    size_t mismatches = 0;
+
+    for (auto& family : families) {
+        const Config<T>* best = nullptr;
+        double bestSeconds = 0;
+        for (auto& config : family) {
+            if (config.workGroupSize > maxWorkGroupSize || config.localMemSize > localMemSize) {
+                continue;
+            }
+            // Run once to compile the kernel, then time one run.
+            config.run(queue, a, b, c, n);
+            queue.wait();
+            const double s = seconds([&]() {
+                config.run(queue, a, b, c, n);
+                queue.wait();
+            });
+            if (verbose) {
+                printf("  tuning %s %-22s %10.1f GFLOP/s\n", type, config.name.c_str(), flops / s / 1e9);
+            }
+            if (best == nullptr || s < bestSeconds) {
+                best = &config;
+                bestSeconds = s;
+            }
+        }
+        if (best == nullptr) {
+            continue;
+        }
+
+        queue.memset(c, 0, n * n * sizeof(T)).wait();
+        const double s = seconds([&]() {
+            for (size_t i = 0; i < iterations; i++) {
+                best->run(queue, a, b, c, n);
+            }
+            queue.wait();
+        }) / std::max<size_t>(iterations, 1);
+        const double gflops = flops / s / 1e9;
+
+        printf("%6s %-24s %10.3f ms %10.1f GFLOP/s %6.1f%% of peak\n",
+            type, best->name.c_str(), s * 1e3, gflops, 100.0 * gflops / peak);
+
+        queue.memcpy(h_c.data(), c, n * n * sizeof(T)).wait();
+        mismatches += check(h_c, reference, type, best->name, tolerance);
+    }
+
+    sycl::free(a, queue);
+    sycl::free(b, queue);
+    sycl::free(c, queue);
+
+    return mismatches;
+}
+
+int main(int argc, char** argv)
+{
+    int platformIndex = 0;
+    int deviceIndex = 0;
+
+    size_t iterations = 8;
+    size_t n = 1024;
+    double peakFloat = 0;
+    double peakHalf = 0;
+    bool verbose = false;
+
+    {
+        popl::OptionParser op("Supported Options");
+        op.add<popl::Value<int>>("p", "platform", "Platform Index", platformIndex, &platformIndex);
+        op.add<popl::Value<int>>("d", "device", "Device Index", deviceIndex, &deviceIndex);
+        op.add<popl::Value<size_t>>("i", "iterations", "Iterations per Kernel", iterations, &iterations);
+        op.add<popl::Value<size_t>>("n", "size", "Matrix Size", n, &n);
+        op.add<popl::Value<double>>("", "peak", "Peak float GFLOP/s (0 = Estimate)", peakFloat, &peakFloat);
+        op.add<popl::Value<double>>("", "peak-half", "Peak half GFLOP/s (0 = Estimate)", peakHalf, &peakHalf);
+        op.add<popl::Switch>("v", "verbose", "Print Every Auto-Tuning Result", &verbose);
+
+        bool printUsage = false;
+        try {
+            op.parse(argc, argv);
+        } catch (std::exception& e) {
+            fprintf(stderr, "Error: %s\n\n", e.what());
+            printUsage = true;
+        }
+
+        if (printUsage || n == 0 || !op.unknown_options().empty() || !op.non_option_args().empty()) {
+            fprintf(stderr,
+                "Usage: gemm [options]\n"
+                "%s", op.help().c_str());
+            return -1;
+        }
+    }
+
+    sycl::platform platform = sycl::platform::get_platforms()[platformIndex];
+    printf("Running on SYCL platform: %s\n", platform.get_info<sycl::info::platform::name>().c_str());
+
+    sycl::device device = platform.get_devices()[deviceIndex];
+    printf("Running on SYCL device: %s\n", device.get_info<sycl::info::device::name>().c_str());
+
+    sycl::context context = sycl::context{ device };
+    sycl::queue queue = sycl::queue{ context, device, sycl::property::queue::in_order() };
+
+    // The theoretical peak is estimated as one fused multiply-add per
+    // native vector lane per compute unit per clock.  This is only a rough
+    // estimate for most devices, so the peak may be passed in instead.
+    const double clockGHz = device.get_info<sycl::info::device::max_clock_frequency>() / 1e3;
+    const double computeUnits = device.get_info<sycl::info::device::max_compute_units>();
+    if (peakFloat <= 0) {
+        peakFloat = 2.0 * computeUnits * clockGHz *
+            device.get_info<sycl::info::device::native_vector_width_float>();
+    }
+    if (peakHalf <= 0) {
+        peakHalf = 2.0 * computeUnits * clockGHz *
+            device.get_info<sycl::info::device::native_vector_width_half>();
+    }
+    printf("Peak: %.1f GFLOP/s float, %.1f GFLOP/s half\n", peakFloat, peakHalf);
+
+    printf("Computing reference for %zu x %zu matrices...\n", n, n);
+    std::vector<float> reference(n * n, 0.0f);
+    for (size_t row = 0; row < n; row++) {
+        for (size_t k = 0; k < n; k++) {
+            const float a = valueA(row, k);
+            for (size_t col = 0; col < n; col++) {
+                reference[row * n + col] += a * valueB(k, col);
+            }
+        }
+    }
+
+    size_t mismatches = runType<float>(queue, "float", n, iterations, peakFloat, 1e-6f, verbose, reference);
+    if (device.has(sycl::aspect::fp16)) {
+        // The sums are exact, but are rounded to half precision when they
+        // are stored.
+        mismatches += runType<sycl::half>(queue, "half", n, iterations, peakHalf, 1e-3f, verbose, reference);
+    } else {
+        printf("Skipping half, device does not support half precision.\n");
+    }
+
+    if (mismatches) {
+        fprintf(stderr, "Error: Found %zu mismatches!!!\n", mismatches);
+        return -1;
+    }
+
+    printf("Success.\n");
+
+    return 0;
+}
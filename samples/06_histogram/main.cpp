@@ -0,0 +1,298 @@
+/*
+// Copyright (c) 2026 Ben Ashbaugh
+//
+// SPDX-License-Identifier: MIT
+*/
+
+#include <sycl/sycl.hpp>
+#include <popl/popl.hpp>
+
+#include <stdio.h>
+#include <algorithm>
+#include <chrono>
+#include <vector>
+
+#include "bmp.hpp"
+#include "julia.hpp"
+
+const char* filename = "histogram.bmp";
+
+using test_clock = std::chrono::high_resolution_clock;
+
+// Computes the escape counts of a Julia set image, histograms them with
+// global atomics, per-work-group bins, and per-sub-group bins for several
+// bin counts, and writes a histogram-equalized image.
+
+// Histogram-equalized coloring: shades each pixel by the fraction of pixels
+// that escaped in fewer iterations, given the cumulative distribution of the
+// escape counts, so the colors are spread evenly across the image.
+class JuliaEqualized {
+public:
+    JuliaEqualized(sycl::uchar4* _dst, const uint32_t* _counts, const float* _cdf) :
+        dst(_dst), counts(_counts), cdf(_cdf) {}
+    void operator()(sycl::id<1> id) const {
+        dst[id] = juliaShade(cdf[counts[id]]);
+    }
+private:
+    sycl::uchar4* dst;
+    const uint32_t* counts;
+    const float* cdf;
+};
+
+// Histograms escape counts in [0, cIterations] into numBins equal bins.
+static inline int histogramBin(uint32_t count, int numBins, int cIterations)
+{
+    return (int)((uint64_t)count * numBins / (cIterations + 1));
+}
+
+// Every pixel increments its bin in global memory with an atomic.
+static void histogramGlobal(sycl::queue& queue, const uint32_t* counts, size_t n,
+    uint32_t* bins, int numBins, int cIterations)
+{
+    queue.parallel_for(sycl::range<1>{n}, [=](sycl::id<1> id) {
+        sycl::atomic_ref<uint32_t,
+            sycl::memory_order::relaxed,
+            sycl::memory_scope::device,
+            sycl::access::address_space::global_space> bin(bins[histogramBin(counts[id], numBins, cIterations)]);
+        bin.fetch_add(1u);
+    });
+}
+
+// Every work-group accumulates a private copy of the bins in local memory,
+// then adds its non-zero bins to the bins in global memory.  When
+// subGroupBins is set, every sub-group accumulates its own private copy of
+// the bins instead, which reduces contention further, and the copies are
+// summed before they are added to global memory.
+static void histogramLocal(sycl::queue& queue, const uint32_t* counts, size_t n,
+    uint32_t* bins, int numBins, int cIterations,
+    size_t groups, size_t localSize, size_t subGroupBins)
+{
+    const size_t copies = std::max<size_t>(subGroupBins, 1);
+    queue.submit([&](sycl::handler& cgh) {
+        sycl::local_accessor<uint32_t, 1> local{ sycl::range<1>{copies * numBins}, cgh };
+        cgh.parallel_for(sycl::nd_range<1>{groups * localSize, localSize}, [=](sycl::nd_item<1> item) {
+            const size_t lid = item.get_local_id(0);
+            for (size_t b = lid; b < copies * numBins; b += localSize) {
+                local[b] = 0;
+            }
+            sycl::group_barrier(item.get_group());
+
+            const size_t copy = subGroupBins ? item.get_sub_group().get_group_linear_id() : 0;
+            for (size_t i = item.get_global_id(0); i < n; i += item.get_global_range(0)) {
+                const int b = histogramBin(counts[i], numBins, cIterations);
+                if (subGroupBins) {
+                    sycl::atomic_ref<uint32_t,
+                        sycl::memory_order::relaxed,
+                        sycl::memory_scope::sub_group,
+                        sycl::access::address_space::local_space> bin(local[copy * numBins + b]);
+                    bin.fetch_add(1u);
+                } else {
+                    sycl::atomic_ref<uint32_t,
+                        sycl::memory_order::relaxed,
+                        sycl::memory_scope::work_group,
+                        sycl::access::address_space::local_space> bin(local[b]);
+                    bin.fetch_add(1u);
+                }
+            }
+            sycl::group_barrier(item.get_group());
+
+            for (size_t b = lid; b < (size_t)numBins; b += localSize) {
+                uint32_t sum = 0;
+                for (size_t c = 0; c < copies; c++) {
+                    sum += local[c * numBins + b];
+                }
+                if (sum) {
+                    sycl::atomic_ref<uint32_t,
+                        sycl::memory_order::relaxed,
+                        sycl::memory_scope::device,
+                        sycl::access::address_space::global_space> bin(bins[b]);
+                    bin.fetch_add(sum);
+                }
+            }
+        });
+    });
+}
+
+// Histograms the escape counts of the image with each strategy for several
+// bin counts, checking each histogram against the host and reporting the
+// throughput, then writes a histogram-equalized image to dst.
+static size_t renderHistogram(
+    sycl::queue& queue, sycl::uchar4* dst,
+    size_t iterations, size_t gwx, size_t gwy, float cr, float ci, int maxIterations)
+{
+    const sycl::device device = queue.get_device();
+    const size_t n = gwx * gwy;
+    const size_t localSize = std::min<size_t>(256, device.get_info<sycl::info::device::max_work_group_size>());
+    const size_t groups = std::min<size_t>(device.get_info<sycl::info::device::max_compute_units>() * 4,
+        (n + localSize - 1) / localSize);
+    const size_t localMemSize = device.get_info<sycl::info::device::local_mem_size>();
+
+    // The number of sub-groups in a work-group is not known on the host, so
+    // allocate enough copies for the smallest sub-group size.
+    const auto sgSizes = device.get_info<sycl::info::device::sub_group_sizes>();
+    const size_t minSubGroupSize = sgSizes.empty() ? 1 : *std::min_element(sgSizes.begin(), sgSizes.end());
+    const size_t subGroups = (localSize + minSubGroupSize - 1) / minSubGroupSize;
+
+    uint32_t* counts = sycl::malloc_device<uint32_t>(n, queue);
+    queue.parallel_for({gwy, gwx}, JuliaCounts(counts, cr, ci, maxIterations)).wait();
+
+    std::vector<uint32_t> h_counts(n);
+    queue.memcpy(h_counts.data(), counts, n * sizeof(uint32_t)).wait();
+
+    const int binCounts[] = { 16, 64, 256, 1024, 4096 };
+    const char* names[] = { "global atomics", "work-group bins", "sub-group bins" };
+
+    printf("Histogramming %zu escape counts:\n", n);
+    printf("%8s", "Bins");
+    for (auto name : names) {
+        printf(" %24s", name);
+    }
+    printf("\n");
+
+    size_t mismatches = 0;
+    uint32_t* bins = sycl::malloc_device<uint32_t>(4096, queue);
+    for (int numBins : binCounts) {
+        std::vector<uint32_t> want(numBins, 0);
+        for (auto count : h_counts) {
+            want[histogramBin(count, numBins, maxIterations)]++;
+        }
+
+        printf("%8d", numBins);
+        for (int s = 0; s < 3; s++) {
+            const size_t copies = s == 2 ? subGroups : 1;
+            if (s > 0 && copies * numBins * sizeof(uint32_t) > localMemSize) {
+                printf(" %24s", "n/a");
+                continue;
+            }
+
+            // Warm up once, so kernel compilation is not measured.
+            std::chrono::duration<float> elapsed_seconds{0};
+            for (size_t i = 0; i <= iterations; i++) {
+                auto start = test_clock::now();
+                queue.memset(bins, 0, numBins * sizeof(uint32_t));
+                if (s == 0) {
+                    histogramGlobal(queue, counts, n, bins, numBins, maxIterations);
+                } else {
+                    histogramLocal(queue, counts, n, bins, numBins, maxIterations,
+                        groups, localSize, s == 2 ? subGroups : 0);
+                }
+                queue.wait();
+                if (i > 0) {
+                    elapsed_seconds += test_clock::now() - start;
+                }
+            }
+
+            std::vector<uint32_t> got(numBins);
+            queue.memcpy(got.data(), bins, numBins * sizeof(uint32_t)).wait();
+            if (got != want) {
+                fprintf(stderr, "Error: %s histogram with %d bins does not match\n", names[s], numBins);
+                mismatches++;
+            }
+
+            const float seconds = elapsed_seconds.count() / std::max<size_t>(iterations, 1);
+            printf(" %12.1f us %5.2f Gpx/s", seconds * 1e6f, n / seconds / 1e9f);
+        }
+        printf("\n");
+    }
+    sycl::free(bins, queue);
+
+    // One bin per escape count, so every count maps to its own level.
+    // Pixels that never escape are always drawn at full intensity.
+    std::vector<uint32_t> histogram(maxIterations + 1, 0);
+    for (auto count : h_counts) {
+        histogram[count]++;
+    }
+    const size_t escaped = n - histogram[maxIterations];
+    std::vector<float> h_cdf(maxIterations + 1, 1.0f);
+    uint64_t sum = 0;
+    for (int i = 0; i < maxIterations; i++) {
+        sum += histogram[i];
+        h_cdf[i] = escaped ? (float)sum / escaped : 1.0f;
+    }
+
+    float* cdf = sycl::malloc_device<float>(maxIterations + 1, queue);
+    queue.memcpy(cdf, h_cdf.data(), (maxIterations + 1) * sizeof(float));
+    queue.parallel_for(sycl::range<1>{n}, JuliaEqualized(dst, counts, cdf)).wait();
+    printf("Rendered histogram-equalized image.\n");
+
+    sycl::free(cdf, queue);
+    sycl::free(counts, queue);
+
+    return mismatches;
+}
+
+int main(int argc, char** argv)
+{
+    int platformIndex = 0;
+    int deviceIndex = 0;
+
+    size_t iterations = 16;
+    size_t gwx = 512;
+    size_t gwy = 512;
+
+    float cr = -0.123f;
+    float ci = 0.745f;
+    int maxIterations = 16;
+
+    {
+        popl::OptionParser op("Supported Options");
+        op.add<popl::Value<int>>("p", "platform", "Platform Index", platformIndex, &platformIndex);
+        op.add<popl::Value<int>>("d", "device", "Device Index", deviceIndex, &deviceIndex);
+        op.add<popl::Value<size_t>>("i", "iterations", "Iterations per Strategy and Bin Count", iterations, &iterations);
+        op.add<popl::Value<size_t>>("", "gwx", "Image Width", gwx, &gwx);
+        op.add<popl::Value<size_t>>("", "gwy", "Image Height", gwy, &gwy);
+        op.add<popl::Value<float>>("", "cr", "Julia Constant Real Part", cr, &cr);
+        op.add<popl::Value<float>>("", "ci", "Julia Constant Imaginary Part", ci, &ci);
+        op.add<popl::Value<int>>("", "maxiter", "Maximum Escape Iterations per Pixel", maxIterations, &maxIterations);
+
+        bool printUsage = false;
+        try {
+            op.parse(argc, argv);
+        } catch (std::exception& e) {
+            fprintf(stderr, "Error: %s\n\n", e.what());
+            printUsage = true;
+        }
+
+        if (printUsage || !op.unknown_options().empty() || !op.non_option_args().empty()) {
+            fprintf(stderr,
+                "Usage: histogram [options]\n"
+                "%s", op.help().c_str());
+            return -1;
+        }
+    }
+
+    if (maxIterations < 1) {
+        fprintf(stderr, "Error: the maximum escape iterations must be at least 1\n");
+        return -1;
+    }
+
+    sycl::platform platform = sycl::platform::get_platforms()[platformIndex];
+    printf("Running on SYCL platform: %s\n", platform.get_info<sycl::info::platform::name>().c_str());
+
+    sycl::device device = platform.get_devices()[deviceIndex];
+    printf("Running on SYCL device: %s\n", device.get_info<sycl::info::device::name>().c_str());
+
+    sycl::context context = sycl::context{ device };
+    sycl::queue queue = sycl::queue{ context, device, sycl::property::queue::in_order() };
+
+    sycl::uchar4* ptr = sycl::malloc_host<sycl::uchar4>(gwx * gwy, queue);
+
+    const size_t mismatches = renderHistogram(queue, ptr, iterations, gwx, gwy, cr, ci, maxIterations);
+
+    if (BMP::save_image(reinterpret_cast<const uint32_t*>(ptr), gwx, gwy, filename)) {
+        printf("Wrote image file %s\n", filename);
+    } else {
+        fprintf(stderr, "Error: could not write image file %s\n", filename);
+    }
+
+    sycl::free(ptr, queue);
+
+    if (mismatches) {
+        fprintf(stderr, "Error: Found %zu mismatches!!!\n", mismatches);
+        return -1;
+    }
+
+    printf("Success.\n");
+
+    return 0;
+}
@@ -0,0 +1,360 @@
+/*
+// Copyright (c) 2026 Ben Ashbaugh
+//
+// SPDX-License-Identifier: MIT
+*/
+
+#include <sycl/sycl.hpp>
+#include <popl/popl.hpp>
+
+#include <stdio.h>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <vector>
+
+#include "bmp.hpp"
+#include "julia.hpp"
+
+const char* filename = "blur.bmp";
+
+using test_clock = std::chrono::high_resolution_clock;
+
+// Renders a Julia set image, then blurs or sharpens it with a naive 2D
+// kernel and with separable row and column kernels that stage tiles in
+// local memory, and writes the result.
+
+// Returns 2 * radius + 1 normalized Gaussian weights, with a standard
+// deviation of half the radius.
+static std::vector<float> blurWeights(int radius)
+{
+    const float sigma = std::max(radius / 2.0f, 0.5f);
+    std::vector<float> weights(2 * radius + 1);
+    float sum = 0.0f;
+    for (int i = -radius; i <= radius; i++) {
+        weights[i + radius] = std::exp(-(i * i) / (2.0f * sigma * sigma));
+        sum += weights[i + radius];
+    }
+    for (auto& w : weights) {
+        w /= sum;
+    }
+    return weights;
+}
+
+// Converts a blurred color to a BGRA color.  To sharpen, the difference
+// between the original color and the blurred color is added to the original
+// color, AKA an unsharp mask.
+static inline sycl::uchar4 blurResult(sycl::float4 blurred, sycl::uchar4 original, bool sharpen)
+{
+    if (sharpen) {
+        blurred = 2.0f * original.convert<float>() - blurred;
+    }
+    return (sycl::clamp(blurred, 0.0f, 255.0f) + 0.5f).convert<std::uint8_t>();
+}
+
+// Reference blur: every pixel reads all (2 * radius + 1)^2 neighbors from
+// global memory.  Pixels past the edges of the image are clamped to the
+// edges.
+class BlurNaive {
+public:
+    BlurNaive(const sycl::uchar4* _src, sycl::uchar4* _dst, const float* _weights, int _radius, bool _sharpen) :
+        src(_src), dst(_dst), weights(_weights), radius(_radius), sharpen(_sharpen) {}
+    void operator()(sycl::item<2> item) const {
+        const int cWidth = item.get_range().get(1);
+        const int cHeight = item.get_range().get(0);
+
+        int x = item.get_id().get(1);
+        int y = item.get_id().get(0);
+
+        sycl::float4 sum{ 0.0f, 0.0f, 0.0f, 0.0f };
+        for (int dy = -radius; dy <= radius; dy++) {
+            const int sy = sycl::clamp(y + dy, 0, cHeight - 1);
+            for (int dx = -radius; dx <= radius; dx++) {
+                const int sx = sycl::clamp(x + dx, 0, cWidth - 1);
+                sum += weights[dy + radius] * weights[dx + radius] * src[ sy * cWidth + sx ].convert<float>();
+            }
+        }
+        dst[ y * cWidth + x ] = blurResult(sum, src[ y * cWidth + x ], sharpen);
+    }
+private:
+    const sycl::uchar4* src;
+    sycl::uchar4* dst;
+    const float* weights;
+    int radius;
+    bool sharpen;
+};
+
+// Separable blur, horizontal pass: every work-group loads its tile plus a
+// halo of radius pixels to the left and right into local memory, then blurs
+// the rows of the tile into a float intermediate image.
+class BlurRows {
+public:
+    BlurRows(const sycl::uchar4* _src, sycl::float4* _dst, const float* _weights, int _radius,
+        int _width, int _height, sycl::local_accessor<sycl::float4, 1> _tile) :
+        src(_src), dst(_dst), weights(_weights), radius(_radius),
+        cWidth(_width), cHeight(_height), tile(_tile) {}
+    void operator()(sycl::nd_item<2> item) const {
+        const int lx = item.get_local_id(1);
+        const int ly = item.get_local_id(0);
+        const int tw = item.get_local_range(1);
+        const int th = item.get_local_range(0);
+        const int x0 = item.get_group(1) * tw - radius;
+        const int y0 = item.get_group(0) * th;
+        const int pitch = tw + 2 * radius;
+
+        for (int i = ly * tw + lx; i < pitch * th; i += tw * th) {
+            const int sx = sycl::clamp(x0 + i % pitch, 0, cWidth - 1);
+            const int sy = sycl::min(y0 + i / pitch, cHeight - 1);
+            tile[i] = src[ sy * cWidth + sx ].convert<float>();
+        }
+        sycl::group_barrier(item.get_group());
+
+        int x = item.get_global_id(1);
+        int y = item.get_global_id(0);
+        if (x < cWidth && y < cHeight) {
+            sycl::float4 sum{ 0.0f, 0.0f, 0.0f, 0.0f };
+            for (int d = 0; d <= 2 * radius; d++) {
+                sum += weights[d] * tile[ ly * pitch + lx + d ];
+            }
+            dst[ y * cWidth + x ] = sum;
+        }
+    }
+private:
+    const sycl::uchar4* src;
+    sycl::float4* dst;
+    const float* weights;
+    int radius;
+    int cWidth;
+    int cHeight;
+    sycl::local_accessor<sycl::float4, 1> tile;
+};
+
+// Separable blur, vertical pass: as above, but the halo is above and below
+// the tile, and the result is converted back to BGRA.
+class BlurColumns {
+public:
+    BlurColumns(const sycl::float4* _src, const sycl::uchar4* _original, sycl::uchar4* _dst,
+        const float* _weights, int _radius, bool _sharpen,
+        int _width, int _height, sycl::local_accessor<sycl::float4, 1> _tile) :
+        src(_src), original(_original), dst(_dst), weights(_weights), radius(_radius), sharpen(_sharpen),
+        cWidth(_width), cHeight(_height), tile(_tile) {}
+    void operator()(sycl::nd_item<2> item) const {
+        const int lx = item.get_local_id(1);
+        const int ly = item.get_local_id(0);
+        const int tw = item.get_local_range(1);
+        const int th = item.get_local_range(0);
+        const int x0 = item.get_group(1) * tw;
+        const int y0 = item.get_group(0) * th - radius;
+        const int rows = th + 2 * radius;
+
+        for (int i = ly * tw + lx; i < tw * rows; i += tw * th) {
+            const int sx = sycl::min(x0 + i % tw, cWidth - 1);
+            const int sy = sycl::clamp(y0 + i / tw, 0, cHeight - 1);
+            tile[i] = src[ sy * cWidth + sx ];
+        }
+        sycl::group_barrier(item.get_group());
+
+        int x = item.get_global_id(1);
+        int y = item.get_global_id(0);
+        if (x < cWidth && y < cHeight) {
+            sycl::float4 sum{ 0.0f, 0.0f, 0.0f, 0.0f };
+            for (int d = 0; d <= 2 * radius; d++) {
+                sum += weights[d] * tile[ (ly + d) * tw + lx ];
+            }
+            dst[ y * cWidth + x ] = blurResult(sum, original[ y * cWidth + x ], sharpen);
+        }
+    }
+private:
+    const sycl::float4* src;
+    const sycl::uchar4* original;
+    sycl::uchar4* dst;
+    const float* weights;
+    int radius;
+    bool sharpen;
+    int cWidth;
+    int cHeight;
+    sycl::local_accessor<sycl::float4, 1> tile;
+};
+
+// Blurs or sharpens src into dst with the naive and separable kernels for
+// every power of two radius up to the requested radius and for the
+// requested radius, reporting megapixels per second.  The separable result
+// must match the naive result to within rounding.  dst is left with the
+// separable result for the requested radius.
+static size_t postProcess(
+    sycl::queue& queue, const sycl::uchar4* src, sycl::uchar4* dst,
+    size_t iterations, size_t gwx, size_t gwy, int blurRadius, bool sharpen)
+{
+    const size_t tileSize = 16;
+    const size_t globalX = (gwx + tileSize - 1) / tileSize * tileSize;
+    const size_t globalY = (gwy + tileSize - 1) / tileSize * tileSize;
+    const size_t n = gwx * gwy;
+
+    const size_t localMemSize = queue.get_device().get_info<sycl::info::device::local_mem_size>();
+    if (tileSize * (tileSize + 2 * blurRadius) * sizeof(sycl::float4) > localMemSize) {
+        fprintf(stderr, "Error: blur radius %d is too large for local memory\n", blurRadius);
+        return 1;
+    }
+
+    sycl::float4* tmp = sycl::malloc_device<sycl::float4>(n, queue);
+    sycl::uchar4* ref = sycl::malloc_host<sycl::uchar4>(n, queue);
+    float* weights = sycl::malloc_device<float>(2 * blurRadius + 1, queue);
+
+    std::vector<int> radii;
+    for (int r = 1; r < blurRadius; r *= 2) {
+        radii.push_back(r);
+    }
+    radii.push_back(blurRadius);
+
+    printf("%s with separable and naive 2D kernels:\n", sharpen ? "Sharpening" : "Blurring");
+    printf("%8s %24s %24s\n", "Radius", "separable", "naive 2D");
+
+    size_t mismatches = 0;
+    for (int radius : radii) {
+        const std::vector<float> h_weights = blurWeights(radius);
+        queue.memcpy(weights, h_weights.data(), h_weights.size() * sizeof(float)).wait();
+
+        auto separable = [&]() {
+            queue.submit([&](sycl::handler& cgh) {
+                sycl::local_accessor<sycl::float4, 1> tile{ sycl::range<1>{tileSize * (tileSize + 2 * radius)}, cgh };
+                cgh.parallel_for(sycl::nd_range<2>{{globalY, globalX}, {tileSize, tileSize}},
+                    BlurRows(src, tmp, weights, radius, (int)gwx, (int)gwy, tile));
+            });
+            queue.submit([&](sycl::handler& cgh) {
+                sycl::local_accessor<sycl::float4, 1> tile{ sycl::range<1>{tileSize * (tileSize + 2 * radius)}, cgh };
+                cgh.parallel_for(sycl::nd_range<2>{{globalY, globalX}, {tileSize, tileSize}},
+                    BlurColumns(tmp, src, dst, weights, radius, sharpen, (int)gwx, (int)gwy, tile));
+            });
+        };
+        auto naive = [&]() {
+            queue.parallel_for({gwy, gwx}, BlurNaive(src, ref, weights, radius, sharpen));
+        };
+
+        float seconds[2];
+        for (int k = 0; k < 2; k++) {
+            // Warm up once, so kernel compilation is not measured.
+            std::chrono::duration<float> elapsed_seconds{0};
+            for (size_t i = 0; i <= iterations; i++) {
+                auto start = test_clock::now();
+                if (k == 0) {
+                    separable();
+                } else {
+                    naive();
+                }
+                queue.wait();
+                if (i > 0) {
+                    elapsed_seconds += test_clock::now() - start;
+                }
+            }
+            seconds[k] = elapsed_seconds.count() / std::max<size_t>(iterations, 1);
+        }
+        printf("%8d %11.1f us %6.1f MP/s %11.1f us %6.1f MP/s\n", radius,
+            seconds[0] * 1e6f, n / seconds[0] / 1e6f,
+            seconds[1] * 1e6f, n / seconds[1] / 1e6f);
+
+        // The separable kernels round differently than the naive kernel.
+        for (size_t p = 0; p < n; p++) {
+            for (int c = 0; c < 4; c++) {
+                if (std::abs((int)dst[p][c] - (int)ref[p][c]) > 1) {
+                    if (mismatches < 16) {
+                        fprintf(stderr, "MisMatch!  radius %d pixel %zu channel %d: separable %d, naive %d\n",
+                            radius, p, c, (int)dst[p][c], (int)ref[p][c]);
+                    }
+                    mismatches++;
+                }
+            }
+        }
+    }
+
+    sycl::free(tmp, queue);
+    sycl::free(ref, queue);
+    sycl::free(weights, queue);
+
+    return mismatches;
+}
+
+int main(int argc, char** argv)
+{
+    int platformIndex = 0;
+    int deviceIndex = 0;
+
+    size_t iterations = 16;
+    size_t gwx = 512;
+    size_t gwy = 512;
+
+    float cr = -0.123f;
+    float ci = 0.745f;
+    int maxIterations = 16;
+
+    int blurRadius = 8;
+    bool sharpen = false;
+
+    {
+        popl::OptionParser op("Supported Options");
+        op.add<popl::Value<int>>("p", "platform", "Platform Index", platformIndex, &platformIndex);
+        op.add<popl::Value<int>>("d", "device", "Device Index", deviceIndex, &deviceIndex);
+        op.add<popl::Value<size_t>>("i", "iterations", "Iterations per Kernel and Radius", iterations, &iterations);
+        op.add<popl::Value<size_t>>("", "gwx", "Image Width", gwx, &gwx);
+        op.add<popl::Value<size_t>>("", "gwy", "Image Height", gwy, &gwy);
+        op.add<popl::Value<float>>("", "cr", "Julia Constant Real Part", cr, &cr);
+        op.add<popl::Value<float>>("", "ci", "Julia Constant Imaginary Part", ci, &ci);
+        op.add<popl::Value<int>>("", "maxiter", "Maximum Escape Iterations per Pixel", maxIterations, &maxIterations);
+        op.add<popl::Value<int>>("", "radius", "Blur Radius", blurRadius, &blurRadius);
+        op.add<popl::Switch>("", "sharpen", "Sharpen Rather Than Blur the Image", &sharpen);
+
+        bool printUsage = false;
+        try {
+            op.parse(argc, argv);
+        } catch (std::exception& e) {
+            fprintf(stderr, "Error: %s\n\n", e.what());
+            printUsage = true;
+        }
+
+        if (printUsage || !op.unknown_options().empty() || !op.non_option_args().empty()) {
+            fprintf(stderr,
+                "Usage: blur [options]\n"
+                "%s", op.help().c_str());
+            return -1;
+        }
+    }
+
+    if (blurRadius < 1) {
+        fprintf(stderr, "Error: the blur radius must be at least 1\n");
+        return -1;
+    }
+
+    sycl::platform platform = sycl::platform::get_platforms()[platformIndex];
+    printf("Running on SYCL platform: %s\n", platform.get_info<sycl::info::platform::name>().c_str());
+
+    sycl::device device = platform.get_devices()[deviceIndex];
+    printf("Running on SYCL device: %s\n", device.get_info<sycl::info::device::name>().c_str());
+
+    sycl::context context = sycl::context{ device };
+    sycl::queue queue = sycl::queue{ context, device, sycl::property::queue::in_order() };
+
+    sycl::uchar4* src = sycl::malloc_host<sycl::uchar4>(gwx * gwy, queue);
+    sycl::uchar4* dst = sycl::malloc_host<sycl::uchar4>(gwx * gwy, queue);
+
+    queue.parallel_for({gwy, gwx}, Julia(src, cr, ci, maxIterations)).wait();
+
+    const size_t mismatches = postProcess(queue, src, dst, iterations, gwx, gwy, blurRadius, sharpen);
+
+    if (BMP::save_image(reinterpret_cast<const uint32_t*>(dst), gwx, gwy, filename)) {
+        printf("Wrote image file %s\n", filename);
+    } else {
+        fprintf(stderr, "Error: could not write image file %s\n", filename);
+    }
+
+    sycl::free(src, queue);
+    sycl::free(dst, queue);
+
+    if (mismatches) {
+        fprintf(stderr, "Error: Found %zu mismatches!!!\n", mismatches);
+        return -1;
+    }
+
+    printf("Success.\n");
+
+    return 0;
+}
@@ -0,0 +1,271 @@
+/*
+// Copyright (c) 2026 Ben Ashbaugh
+//
+// SPDX-License-Identifier: MIT
+*/
+
+#include <sycl/sycl.hpp>
+#include <popl/popl.hpp>
+
+#include <stdio.h>
+#include <algorithm>
+#include <chrono>
+
+#include "julia.hpp"
+#include "tilecache.hpp"
+
+using test_clock = std::chrono::high_resolution_clock;
+
+// Pans across a Julia set image like an interactive viewer, rendering only
+// the tiles that are not already in a least recently used tile cache, and
+// compares against rendering every frame in full.
+
+// A tile to render into a cache slot, in tile coordinates.
+struct TileJob {
+    int x;
+    int y;
+    int slot;
+};
+
+// Renders each tile in a list of tiles into its cache slot.  Tiles are
+// square, and pixel (x, y) of the image at this zoom level is pixel
+// (x % tileSize, y % tileSize) of tile (x / tileSize, y / tileSize).
+class JuliaCacheFill {
+public:
+    JuliaCacheFill(sycl::uchar4* _slots, const TileJob* _jobs, float _cr, float _ci, int _iterations,
+        int _cWidth, int _tileSize) :
+        slots(_slots), jobs(_jobs), cr(_cr), ci(_ci), cIterations(_iterations),
+        cWidth(_cWidth), tileSize(_tileSize) {}
+    void operator()(sycl::item<3> item) const {
+        const TileJob job = jobs[item.get_id(0)];
+        const int ty = item.get_id(1);
+        const int tx = item.get_id(2);
+
+        int x = job.x * tileSize + tx;
+        int y = job.y * tileSize + ty;
+
+        slots[ (job.slot * tileSize + ty) * tileSize + tx ] = juliaColor(x, y, cWidth, cr, ci, cIterations);
+    }
+private:
+    sycl::uchar4* slots;
+    const TileJob* jobs;
+    float cr;
+    float ci;
+    int cIterations;
+    int cWidth;
+    int tileSize;
+};
+
+// Copies the cached tiles covering a viewport into the image.  The table
+// holds the slot for each tile covering the viewport, in row-major order
+// starting from tile (firstX, firstY).
+class JuliaCacheCompose {
+public:
+    JuliaCacheCompose(sycl::uchar4* _dst, const sycl::uchar4* _slots, const int* _table,
+        int _panX, int _panY, int _firstX, int _firstY, int _tilesX, int _tileSize) :
+        dst(_dst), slots(_slots), table(_table), panX(_panX), panY(_panY),
+        firstX(_firstX), firstY(_firstY), tilesX(_tilesX), tileSize(_tileSize) {}
+    void operator()(sycl::item<2> item) const {
+        const int width = item.get_range().get(1);
+
+        int x = item.get_id().get(1);
+        int y = item.get_id().get(0);
+
+        const int px = x + panX;
+        const int py = y + panY;
+        const int slot = table[ (py / tileSize - firstY) * tilesX + (px / tileSize - firstX) ];
+
+        dst[ y * width + x ] = slots[ (slot * tileSize + py % tileSize) * tileSize + px % tileSize ];
+    }
+private:
+    sycl::uchar4* dst;
+    const sycl::uchar4* slots;
+    const int* table;
+    int panX;
+    int panY;
+    int firstX;
+    int firstY;
+    int tilesX;
+    int tileSize;
+};
+
+// Renders a sequence of frames that pan across the image and back, like an
+// interactive viewer, once with a tile cache and once rendering every frame
+// in full, and compares the frames.  With the cache, only tiles that are
+// not already cached are rendered, then the cached tiles are copied into
+// the frame.  The zoom level is the image width, which sets the scale.
+static size_t renderPanned(
+    sycl::queue& queue, size_t frames, int step, size_t capacity,
+    size_t gwx, size_t gwy, float cr, float ci, int maxIterations)
+{
+    const int tileSize = 64;
+    const int zoom = (int)gwx;
+    const size_t n = gwx * gwy;
+
+    // Every tile covering a frame must fit in the cache.
+    const size_t tilesX = (gwx + tileSize - 1) / tileSize + 1;
+    const size_t tilesY = (gwy + tileSize - 1) / tileSize + 1;
+    const size_t tilesPerFrame = tilesX * tilesY;
+    if (capacity == 0) {
+        capacity = tilesPerFrame * 4;
+    } else if (capacity < tilesPerFrame) {
+        printf("Increasing the tile cache from %zu to %zu tiles to hold a frame.\n", capacity, tilesPerFrame);
+        capacity = tilesPerFrame;
+    }
+    printf("Panning %zu frames by %d pixels with a cache of %zu %dx%d tiles (%zu bytes).\n",
+        frames, step, capacity, tileSize, tileSize, capacity * tileSize * tileSize * sizeof(sycl::uchar4));
+
+    TileCache cache(capacity);
+    sycl::uchar4* slots = sycl::malloc_device<sycl::uchar4>(capacity * tileSize * tileSize, queue);
+    TileJob* jobs = sycl::malloc_shared<TileJob>(tilesPerFrame, queue);
+    int* table = sycl::malloc_shared<int>(tilesPerFrame, queue);
+    sycl::uchar4* dst = sycl::malloc_host<sycl::uchar4>(n, queue);
+    sycl::uchar4* reference = sycl::malloc_host<sycl::uchar4>(n, queue);
+
+    // Pans diagonally for the first half of the frames, then back.
+    auto pan = [=](size_t f, int& panX, int& panY) {
+        const int position = (int)(f <= frames / 2 ? f : frames - f);
+        panX = position * step;
+        panY = position * step / 2;
+    };
+
+    std::chrono::duration<float> cached_seconds{0};
+    std::chrono::duration<float> uncached_seconds{0};
+    size_t mismatches = 0;
+    for (int run = 0; run < 2; run++) {
+        // Warm up once, so kernel compilation is not measured.
+        cache.clear();
+        cached_seconds = uncached_seconds = std::chrono::duration<float>{0};
+        for (size_t f = 0; f < frames; f++) {
+            int panX, panY;
+            pan(f, panX, panY);
+
+            auto start = test_clock::now();
+            const int firstX = panX / tileSize;
+            const int firstY = panY / tileSize;
+            const int lastX = (panX + (int)gwx - 1) / tileSize;
+            const int lastY = (panY + (int)gwy - 1) / tileSize;
+            const int frameTilesX = lastX - firstX + 1;
+            size_t count = 0;
+            for (int ty = firstY; ty <= lastY; ty++) {
+                for (int tx = firstX; tx <= lastX; tx++) {
+                    size_t slot = 0;
+                    if (!cache.lookup(TileCache::Key{ cr, ci, maxIterations, zoom, tx, ty }, slot)) {
+                        jobs[count++] = TileJob{ tx, ty, (int)slot };
+                    }
+                    table[(ty - firstY) * frameTilesX + (tx - firstX)] = (int)slot;
+                }
+            }
+            if (count > 0) {
+                queue.parallel_for(sycl::range<3>{count, (size_t)tileSize, (size_t)tileSize},
+                    JuliaCacheFill(slots, jobs, cr, ci, maxIterations, zoom, tileSize));
+            }
+            queue.parallel_for({gwy, gwx},
+                JuliaCacheCompose(dst, slots, table, panX, panY, firstX, firstY, frameTilesX, tileSize));
+            queue.wait();
+            cached_seconds += test_clock::now() - start;
+
+            start = test_clock::now();
+            queue.parallel_for({gwy, gwx}, [=](sycl::item<2> item) {
+                int x = item.get_id().get(1);
+                int y = item.get_id().get(0);
+                reference[ y * gwx + x ] = juliaColor(x + panX, y + panY, zoom, cr, ci, maxIterations);
+            });
+            queue.wait();
+            uncached_seconds += test_clock::now() - start;
+
+            if (run > 0) {
+                mismatches += compareImages(dst, reference, n).mismatches;
+            }
+        }
+    }
+
+    const size_t lookups = cache.hits() + cache.misses();
+    printf("Tile cache: %zu hits, %zu misses, %zu evictions, %.1f%% hit rate\n",
+        cache.hits(), cache.misses(), cache.evictions(),
+        lookups ? 100.0 * cache.hits() / lookups : 0.0);
+    printf("Panning finished in %f seconds cached vs. %f seconds uncached, saved %f seconds (%.2fx)\n",
+        cached_seconds.count(), uncached_seconds.count(),
+        (uncached_seconds - cached_seconds).count(),
+        uncached_seconds.count() / cached_seconds.count());
+    if (mismatches) {
+        fprintf(stderr, "Error: %zu pixels differ between cached and uncached frames\n", mismatches);
+    } else {
+        printf("Cached frames are identical to uncached frames.\n");
+    }
+
+    sycl::free(slots, queue);
+    sycl::free(jobs, queue);
+    sycl::free(table, queue);
+    sycl::free(dst, queue);
+    sycl::free(reference, queue);
+
+    return mismatches;
+}
+
+int main(int argc, char** argv)
+{
+    int platformIndex = 0;
+    int deviceIndex = 0;
+
+    size_t gwx = 512;
+    size_t gwy = 512;
+
+    float cr = -0.123f;
+    float ci = 0.745f;
+    int maxIterations = 16;
+
+    size_t frames = 32;
+    int step = 32;
+    size_t cacheTiles = 0;
+
+    {
+        popl::OptionParser op("Supported Options");
+        op.add<popl::Value<int>>("p", "platform", "Platform Index", platformIndex, &platformIndex);
+        op.add<popl::Value<int>>("d", "device", "Device Index", deviceIndex, &deviceIndex);
+        op.add<popl::Value<size_t>>("", "gwx", "Image Width", gwx, &gwx);
+        op.add<popl::Value<size_t>>("", "gwy", "Image Height", gwy, &gwy);
+        op.add<popl::Value<float>>("", "cr", "Julia Constant Real Part", cr, &cr);
+        op.add<popl::Value<float>>("", "ci", "Julia Constant Imaginary Part", ci, &ci);
+        op.add<popl::Value<int>>("", "maxiter", "Maximum Escape Iterations per Pixel", maxIterations, &maxIterations);
+        op.add<popl::Value<size_t>>("", "frames", "Number of Panned Frames", frames, &frames);
+        op.add<popl::Value<int>>("", "step", "Pixels to Pan per Frame", step, &step);
+        op.add<popl::Value<size_t>>("", "cache-tiles", "Tile Cache Capacity in Tiles (0 = Auto)", cacheTiles, &cacheTiles);
+
+        bool printUsage = false;
+        try {
+            op.parse(argc, argv);
+        } catch (std::exception& e) {
+            fprintf(stderr, "Error: %s\n\n", e.what());
+            printUsage = true;
+        }
+
+        if (printUsage || !op.unknown_options().empty() || !op.non_option_args().empty()) {
+            fprintf(stderr,
+                "Usage: tilecache [options]\n"
+                "%s", op.help().c_str());
+            return -1;
+        }
+    }
+
+    sycl::platform platform = sycl::platform::get_platforms()[platformIndex];
+    printf("Running on SYCL platform: %s\n", platform.get_info<sycl::info::platform::name>().c_str());
+
+    sycl::device device = platform.get_devices()[deviceIndex];
+    printf("Running on SYCL device: %s\n", device.get_info<sycl::info::device::name>().c_str());
+
+    sycl::context context = sycl::context{ device };
+    sycl::queue queue = sycl::queue{ context, device, sycl::property::queue::in_order() };
+
+    const size_t mismatches = renderPanned(queue, frames, std::max(step, 0), cacheTiles,
+        gwx, gwy, cr, ci, maxIterations);
+
+    if (mismatches) {
+        fprintf(stderr, "Error: Found %zu mismatches!!!\n", mismatches);
+        return -1;
+    }
+
+    printf("Success.\n");
+
+    return 0;
+}
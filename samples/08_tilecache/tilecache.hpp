@@ -0,0 +1,105 @@
+/*
+// Copyright (c) 2026 Ben Ashbaugh
+//
+// SPDX-License-Identifier: MIT
+*/
+
+#pragma once
+#include <list>
+#include <unordered_map>
+#include <utility>
+#include <stdint.h>
+#include <string.h>
+
+// Host-side bookkeeping for a cache of rendered image tiles.  The tile
+// pixels live in a pool of fixed-size slots allocated by the caller, and
+// the cache maps each tile to a slot.  When the cache is full, the least
+// recently used tile is evicted and its slot is reused.
+class TileCache {
+public:
+    // Identifies a rendered tile: the Julia constant, the iteration limit,
+    // the zoom level, and the tile coordinates at that zoom level.
+    struct Key {
+        float cr;
+        float ci;
+        int iterations;
+        int zoom;
+        int x;
+        int y;
+
+        bool operator==(const Key& other) const {
+            return cr == other.cr && ci == other.ci &&
+                iterations == other.iterations && zoom == other.zoom &&
+                x == other.x && y == other.y;
+        }
+    };
+
+    explicit TileCache(size_t _capacity) : slots(_capacity) {}
+
+    size_t capacity() const { return slots; }
+    size_t size() const { return lru.size(); }
+
+    // Looks up a tile and marks it as most recently used.  Returns true and
+    // the slot holding the tile on a hit.  On a miss, returns false and the
+    // slot assigned to the tile, which the caller must fill.
+    bool lookup(const Key& key, size_t& slot) {
+        auto it = map.find(key);
+        if (it != map.end()) {
+            lru.splice(lru.begin(), lru, it->second);
+            slot = it->second->second;
+            hitCount++;
+            return true;
+        }
+
+        if (lru.size() < slots) {
+            slot = lru.size();
+        } else {
+            slot = lru.back().second;
+            map.erase(lru.back().first);
+            lru.pop_back();
+            evictionCount++;
+        }
+        lru.emplace_front(key, slot);
+        map[key] = lru.begin();
+        missCount++;
+        return false;
+    }
+
+    void clear() {
+        lru.clear();
+        map.clear();
+        hitCount = missCount = evictionCount = 0;
+    }
+
+    size_t hits() const { return hitCount; }
+    size_t misses() const { return missCount; }
+    size_t evictions() const { return evictionCount; }
+
+private:
+    struct KeyHash {
+        size_t operator()(const Key& key) const {
+            uint32_t words[6];
+            memcpy(&words[0], &key.cr, sizeof(uint32_t));
+            memcpy(&words[1], &key.ci, sizeof(uint32_t));
+            memcpy(&words[2], &key.iterations, sizeof(uint32_t));
+            memcpy(&words[3], &key.zoom, sizeof(uint32_t));
+            memcpy(&words[4], &key.x, sizeof(uint32_t));
+            memcpy(&words[5], &key.y, sizeof(uint32_t));
+            uint64_t hash = 14695981039346656037ull;
+            for (uint32_t w : words) {
+                hash = (hash ^ w) * 1099511628211ull;
+            }
+            return static_cast<size_t>(hash);
+        }
+    };
+
+    using Entry = std::pair<Key, size_t>;
+
+    size_t slots;
+    std::list<Entry> lru;   // most recently used first
+    std::unordered_map<Key, std::list<Entry>::iterator, KeyHash> map;
+
+    size_t hitCount = 0;
+    size_t missCount = 0;
+    size_t evictionCount = 0;
+};
@@ -0,0 +1,222 @@
+/*
+// Copyright (c) 2026 Ben Ashbaugh
+//
+// SPDX-License-Identifier: MIT
+*/
+
+#include <sycl/sycl.hpp>
+#include <popl/popl.hpp>
+
+#include <stdio.h>
+#include <algorithm>
+#include <chrono>
+
+#include "julia.hpp"
+
+using test_clock = std::chrono::high_resolution_clock;
+
+// Renders a Julia set image with the kernel parameters passed as kernel
+// arguments, as specialization constants, and as compile-time constants,
+// and measures the JIT cost of new specialization constant values.
+
+// Default image width, Julia constant, and iteration limit.  These are also
+// the parameters of the compile-time constant variant.
+constexpr int cDefaultWidth = 512;
+constexpr float cDefaultCr = -0.123f;
+constexpr float cDefaultCi = 0.745f;
+constexpr int cDefaultIterations = 16;
+
+// Specialization constants for the Julia kernel parameters.  The values are
+// set when the kernel is submitted, and the JIT compiler can fold them into
+// the kernel, like compile-time constants.
+constexpr sycl::specialization_id<int> juliaWidthId(cDefaultWidth);
+constexpr sycl::specialization_id<float> juliaCrId(cDefaultCr);
+constexpr sycl::specialization_id<float> juliaCiId(cDefaultCi);
+constexpr sycl::specialization_id<int> juliaIterationsId(cDefaultIterations);
+
+// Specialized variant: all parameters except the destination are
+// specialization constants, see submitSpecialized.
+class JuliaSpecialized {
+public:
+    JuliaSpecialized(sycl::uchar4* _dst) : dst(_dst) {}
+    void operator()(sycl::item<2> item, sycl::kernel_handler kh) const {
+        const int cWidth = kh.get_specialization_constant<juliaWidthId>();
+        const float cr = kh.get_specialization_constant<juliaCrId>();
+        const float ci = kh.get_specialization_constant<juliaCiId>();
+        const int cIterations = kh.get_specialization_constant<juliaIterationsId>();
+
+        int x = item.get_id().get(1);
+        int y = item.get_id().get(0);
+
+        dst[ y * cWidth + x ] = juliaColor(x, y, cWidth, cr, ci, cIterations);
+    }
+private:
+    sycl::uchar4* dst;
+};
+
+// Compile-time constant variant: all parameters except the destination are
+// the default parameters.
+class JuliaConstant {
+public:
+    JuliaConstant(sycl::uchar4* _dst) : dst(_dst) {}
+    void operator()(sycl::item<2> item) const {
+        int x = item.get_id().get(1);
+        int y = item.get_id().get(0);
+
+        dst[ y * cDefaultWidth + x ] = juliaColor(x, y, cDefaultWidth, cDefaultCr, cDefaultCi, cDefaultIterations);
+    }
+private:
+    sycl::uchar4* dst;
+};
+
+static sycl::event submitSpecialized(sycl::queue& queue, sycl::uchar4* dst,
+    size_t gwx, size_t gwy, float cr, float ci, int maxIterations)
+{
+    return queue.submit([&](sycl::handler& cgh) {
+        cgh.set_specialization_constant<juliaWidthId>((int)gwx);
+        cgh.set_specialization_constant<juliaCrId>(cr);
+        cgh.set_specialization_constant<juliaCiId>(ci);
+        cgh.set_specialization_constant<juliaIterationsId>(maxIterations);
+        cgh.parallel_for(sycl::range<2>{gwy, gwx}, JuliaSpecialized(dst));
+    });
+}
+
+// Compares argument-passed, specialized, and compile-time constant variants
+// of the Julia kernel, then measures the cost of the first launch with new
+// specialization constant values, which compiles a new kernel.  The
+// compile-time constant variant only runs with the default parameters.
+static void renderSpecialized(
+    sycl::queue& queue, const sycl::uchar4* reference,
+    size_t iterations, size_t gwx, size_t gwy, float cr, float ci, int maxIterations)
+{
+    const size_t n = gwx * gwy;
+    sycl::uchar4* dst = sycl::malloc_host<sycl::uchar4>(n, queue);
+
+    const bool constant = gwx == cDefaultWidth && cr == cDefaultCr && ci == cDefaultCi &&
+        maxIterations == cDefaultIterations;
+
+    const char* names[] = { "arguments", "specialized", "compile-time constants" };
+    std::chrono::duration<float> seconds[3];
+    for (int v = 0; v < 3; v++) {
+        if (v == 2 && !constant) {
+            continue;
+        }
+
+        // Warm up once, so kernel compilation is not measured.
+        for (size_t i = 0; i <= iterations; i++) {
+            if (i == 1) {
+                queue.wait();
+                seconds[v] = std::chrono::duration<float>{0};
+            }
+            auto start = test_clock::now();
+            switch (v) {
+            case 0: queue.parallel_for({gwy, gwx}, Julia(dst, cr, ci, maxIterations)); break;
+            case 1: submitSpecialized(queue, dst, gwx, gwy, cr, ci, maxIterations); break;
+            case 2: queue.parallel_for({gwy, gwx}, JuliaConstant(dst)); break;
+            }
+            if (i == iterations) {
+                queue.wait();
+            }
+            seconds[v] += test_clock::now() - start;
+        }
+
+        const size_t mismatches = compareImages(dst, reference, n).mismatches;
+        printf("Kernel parameters as %s finished in %f seconds (%.2fx vs. arguments)",
+            names[v], seconds[v].count(), seconds[0].count() / seconds[v].count());
+        if (mismatches) {
+            printf(", %zu pixels differ from the full render\n", mismatches);
+        } else {
+            printf("\n");
+        }
+    }
+    if (!constant) {
+        printf("Kernel parameters as compile-time constants: skipped, requires the default parameters\n");
+    }
+
+    // Each new set of specialization constant values compiles a new kernel,
+    // but new argument values do not.
+    const int specializations = 4;
+    std::chrono::duration<float> specialized_first{0};
+    std::chrono::duration<float> arguments_first{0};
+    for (int s = 1; s <= specializations; s++) {
+        const float newCi = ci + s * 0.001f;
+
+        auto start = test_clock::now();
+        submitSpecialized(queue, dst, gwx, gwy, cr, newCi, maxIterations).wait();
+        specialized_first += test_clock::now() - start;
+
+        start = test_clock::now();
+        queue.parallel_for({gwy, gwx}, Julia(dst, cr, newCi, maxIterations)).wait();
+        arguments_first += test_clock::now() - start;
+    }
+    const float specialized_launch = seconds[1].count() / std::max<size_t>(iterations, 1);
+    const float specialized_jit = specialized_first.count() / specializations - specialized_launch;
+    printf("First launch with new values: specialized %f ms, arguments %f ms, "
+        "%f ms JIT per specialization\n",
+        specialized_first.count() * 1e3f / specializations,
+        arguments_first.count() * 1e3f / specializations,
+        specialized_jit * 1e3f);
+
+    sycl::free(dst, queue);
+}
+
+int main(int argc, char** argv)
+{
+    int platformIndex = 0;
+    int deviceIndex = 0;
+
+    size_t iterations = 16;
+    size_t gwx = cDefaultWidth;
+    size_t gwy = cDefaultWidth;
+
+    float cr = cDefaultCr;
+    float ci = cDefaultCi;
+    int maxIterations = cDefaultIterations;
+
+    {
+        popl::OptionParser op("Supported Options");
+        op.add<popl::Value<int>>("p", "platform", "Platform Index", platformIndex, &platformIndex);
+        op.add<popl::Value<int>>("d", "device", "Device Index", deviceIndex, &deviceIndex);
+        op.add<popl::Value<size_t>>("i", "iterations", "Iterations per Variant", iterations, &iterations);
+        op.add<popl::Value<size_t>>("", "gwx", "Image Width", gwx, &gwx);
+        op.add<popl::Value<size_t>>("", "gwy", "Image Height", gwy, &gwy);
+        op.add<popl::Value<float>>("", "cr", "Julia Constant Real Part", cr, &cr);
+        op.add<popl::Value<float>>("", "ci", "Julia Constant Imaginary Part", ci, &ci);
+        op.add<popl::Value<int>>("", "maxiter", "Maximum Escape Iterations per Pixel", maxIterations, &maxIterations);
+
+        bool printUsage = false;
+        try {
+            op.parse(argc, argv);
+        } catch (std::exception& e) {
+            fprintf(stderr, "Error: %s\n\n", e.what());
+            printUsage = true;
+        }
+
+        if (printUsage || !op.unknown_options().empty() || !op.non_option_args().empty()) {
+            fprintf(stderr,
+                "Usage: specialize [options]\n"
+                "%s", op.help().c_str());
+            return -1;
+        }
+    }
+
+    sycl::platform platform = sycl::platform::get_platforms()[platformIndex];
+    printf("Running on SYCL platform: %s\n", platform.get_info<sycl::info::platform::name>().c_str());
+
+    sycl::device device = platform.get_devices()[deviceIndex];
+    printf("Running on SYCL device: %s\n", device.get_info<sycl::info::device::name>().c_str());
+
+    sycl::context context = sycl::context{ device };
+    sycl::queue queue = sycl::queue{ context, device, sycl::property::queue::in_order() };
+
+    sycl::uchar4* reference = sycl::malloc_host<sycl::uchar4>(gwx * gwy, queue);
+    queue.parallel_for({gwy, gwx}, Julia(reference, cr, ci, maxIterations)).wait();
+
+    renderSpecialized(queue, reference, iterations, gwx, gwy, cr, ci, maxIterations);
+
+    sycl::free(reference, queue);
+
+    printf("Success.\n");
+
+    return 0;
+}
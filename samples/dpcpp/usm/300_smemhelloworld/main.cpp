@@ -7,6 +7,9 @@
 #include <sycl/sycl.hpp>
 #include <iostream>
 
+#include "chrometrace/chrometrace.hpp"
+#include "devicecache/devicecache.hpp"
+
 using namespace sycl;
 
 const size_t  gwx = 1024*1024;
@@ -18,6 +21,8 @@ int main(
     bool printUsage = false;
     int pi = 0;
     int di = 0;
+    std::string traceFile;
+    std::string cacheDir;
 
     if (argc < 1) {
         printUsage = true;
@@ -34,6 +39,16 @@ int main(
                     pi = strtol(argv[i], NULL, 10);
                 }
             }
+            else if (!strcmp( argv[i], "-trace")) {
+                if (++i < argc) {
+                    traceFile = argv[i];
+                }
+            }
+            else if (!strcmp( argv[i], "-cache")) {
+                if (++i < argc) {
+                    cacheDir = argv[i];
+                }
+            }
             else {
                 printUsage = true;
             }
@@ -45,15 +60,24 @@ int main(
             "Options:\n"
             "      -d: Device Index (default = 0)\n"
             "      -p: Platform Index (default = 0)\n"
+            "      -trace: Write a Chrome Trace of Queue Activity to File\n"
+            "      -cache: Cache Compiled Device Code in Directory\n"
             ;
         return -1;
     }
 
     // setup
-    queue q{ platform::get_platforms()[pi].get_devices()[di], property::queue::in_order() };
+    if (!devicecache::enable(cacheDir)) {
+        std::cerr << "Error: Couldn't enable the device code cache in " << cacheDir << "!\n";
+        return -1;
+    }
 
-    auto d = q.get_device();
-    auto c = q.get_context();
+    chrometrace::Tracer tracer{ traceFile };
+    queue sq{ platform::get_platforms()[pi].get_devices()[di], chrometrace::queue_properties(tracer) };
+    chrometrace::Queue q{ sq, tracer };
+
+    auto d = sq.get_device();
+    auto c = sq.get_context();
 
     std::cout << "Running on SYCL platform: " << 
         d.get_platform().get_info<info::platform::name>() << std::endl;
@@ -73,7 +97,7 @@ int main(
 
         // go
 
-        q.parallel_for(range<1>{gwx}, [=](id<1> id) {
+        q.label("kernel").parallel_for(range<1>{gwx}, [=](id<1> id) {
             s_dst[id] = s_src[id];
         });
 
@@ -102,6 +126,10 @@ int main(
         }
     }
 
+    if (!tracer.write()) {
+        std::cerr << "Error: Couldn't write trace file " << traceFile << "!\n";
+    }
+
     // clean up
     free(s_src, c);
     free(s_dst, c);
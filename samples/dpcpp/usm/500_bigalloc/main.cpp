@@ -7,6 +7,9 @@
 #include <sycl/sycl.hpp>
 #include <iostream>
 
+#include "chrometrace/chrometrace.hpp"
+#include "devicecache/devicecache.hpp"
+
 using namespace sycl;
 
 enum AllocType {
@@ -24,6 +27,8 @@ int main(
     int pi = 0;
     int di = 0;
     int sz = 2;
+    std::string traceFile;
+    std::string cacheDir;
 
     if (argc < 1) {
         printUsage = true;
@@ -54,6 +59,16 @@ int main(
             else if (!strcmp( argv[i], "-shared")) {
                 allocType = Shared;
             }
+            else if (!strcmp( argv[i], "-trace")) {
+                if (++i < argc) {
+                    traceFile = argv[i];
+                }
+            }
+            else if (!strcmp( argv[i], "-cache")) {
+                if (++i < argc) {
+                    cacheDir = argv[i];
+                }
+            }
             else {
                 printUsage = true;
             }
@@ -69,17 +84,26 @@ int main(
             "      -device: Test Device Allocations (default)\n"
             "      -host: Test Host Allocations\n"
             "      -shared: Test Shared Allocations\n"
+            "      -trace: Write a Chrome Trace of Queue Activity to File\n"
+            "      -cache: Cache Compiled Device Code in Directory\n"
             ;
         return -1;
     }
 
     // setup
-    queue q{ platform::get_platforms()[pi].get_devices()[di], property::queue::in_order() };
+    if (!devicecache::enable(cacheDir)) {
+        std::cerr << "Error: Couldn't enable the device code cache in " << cacheDir << "!\n";
+        return -1;
+    }
+
+    chrometrace::Tracer tracer{ traceFile };
+    queue sq{ platform::get_platforms()[pi].get_devices()[di], chrometrace::queue_properties(tracer) };
+    chrometrace::Queue q{ sq, tracer };
 
     constexpr float GB = 1024.0f * 1024.0f * 1024.0f;
 
-    auto d = q.get_device();
-    auto c = q.get_context();
+    auto d = sq.get_device();
+    auto c = sq.get_context();
 
     std::cout << "Running on SYCL platform: " << 
         d.get_platform().get_info<info::platform::name>() << "\n";
@@ -112,11 +136,11 @@ int main(
             h_buf[i] = (uint32_t)i;
         }
 
-        q.memcpy(d_buf, h_buf, allocSize * sizeof(uint32_t));
+        q.label("upload").memcpy(d_buf, h_buf, allocSize * sizeof(uint32_t));
 
         // go
 
-        q.parallel_for(range<1>{gwx}, [=](id<1> id) {
+        q.label("kernel").parallel_for(range<1>{gwx}, [=](id<1> id) {
             for(size_t i = 0; i < 1024; i++) {
                 d_buf[id * 1024 + i] += 2;
             }
@@ -124,7 +148,7 @@ int main(
 
         // check results
 
-        q.memcpy(h_buf, d_buf, allocSize * sizeof(uint32_t)).wait();    // blocking
+        q.label("download").memcpy(h_buf, d_buf, allocSize * sizeof(uint32_t)).wait();    // blocking
 
         unsigned int    mismatches = 0;
         for( size_t i = 0; i < allocSize; i++ ) {
@@ -150,6 +174,10 @@ int main(
         std::cerr << "Allocation failed!  h_buf = " << h_buf << ", d_buf == " << d_buf << "\n";
     }
 
+    if (!tracer.write()) {
+        std::cerr << "Error: Couldn't write trace file " << traceFile << "!\n";
+    }
+
     // clean up
     delete [] h_buf;
     free(d_buf, c);
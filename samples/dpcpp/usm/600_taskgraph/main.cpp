@@ -0,0 +1,233 @@
+/*
+// Copyright (c) 2026 Ben Ashbaugh
+//
+// SPDX-License-Identifier: MIT
+*/
+
+#include <sycl/sycl.hpp>
+#include <chrono>
+#include <iostream>
+#include <string>
+
+#include "chrometrace/chrometrace.hpp"
+#include "taskgraph.hpp"
+
+using namespace sycl;
+
+using test_clock = std::chrono::high_resolution_clock;
+
+const size_t  gwx = 16*1024*1024;
+
+// Applies a few rounds of a linear congruential generator, so each chunk
+// has enough compute to overlap with copies of other chunks.
+static inline uint32_t compute(uint32_t value, int work)
+{
+    for (int k = 0; k < work; k++) {
+        value = value * 1664525u + 1013904223u;
+    }
+    return value;
+}
+
+int main(
+    int argc,
+    char** argv )
+{
+    bool printUsage = false;
+    int pi = 0;
+    int di = 0;
+    int chunks = 8;
+    int computeQueueCount = 2;
+    int work = 64;
+    std::string traceFile;
+
+    if (argc < 1) {
+        printUsage = true;
+    }
+    else {
+        for (size_t i = 1; i < argc; i++) {
+            if (!strcmp( argv[i], "-d" )) {
+                if (++i < argc) {
+                    di = strtol(argv[i], NULL, 10);
+                }
+            }
+            else if (!strcmp( argv[i], "-p")) {
+                if (++i < argc) {
+                    pi = strtol(argv[i], NULL, 10);
+                }
+            }
+            else if (!strcmp( argv[i], "-c")) {
+                if (++i < argc) {
+                    chunks = strtol(argv[i], NULL, 10);
+                }
+            }
+            else if (!strcmp( argv[i], "-q")) {
+                if (++i < argc) {
+                    computeQueueCount = strtol(argv[i], NULL, 10);
+                }
+            }
+            else if (!strcmp( argv[i], "-w")) {
+                if (++i < argc) {
+                    work = strtol(argv[i], NULL, 10);
+                }
+            }
+            else if (!strcmp( argv[i], "-trace")) {
+                if (++i < argc) {
+                    traceFile = argv[i];
+                }
+            }
+            else {
+                printUsage = true;
+            }
+        }
+    }
+    if (chunks < 1 || computeQueueCount < 1 || gwx % chunks != 0) {
+        printUsage = true;
+    }
+    if (printUsage) {
+        std::cerr <<
+            "Usage: taskgraph  [options]\n"
+            "Options:\n"
+            "      -d: Device Index (default = 0)\n"
+            "      -p: Platform Index (default = 0)\n"
+            "      -c: Number of Chunks, Must Divide 16M (default = 8)\n"
+            "      -q: Number of Compute Queues (default = 2)\n"
+            "      -w: Compute Work per Element (default = 64)\n"
+            "      -trace: Write a Chrome Trace of Queue Activity to File\n"
+            ;
+        return -1;
+    }
+
+    // setup
+    device d = platform::get_platforms()[pi].get_devices()[di];
+    context c{ d };
+
+    std::cout << "Running on SYCL platform: " <<
+        d.get_platform().get_info<info::platform::name>() << std::endl;
+    std::cout << "Running on SYCL device: " <<
+        d.get_info<info::device::name>() << std::endl;
+
+    // The serial baseline uses a single in-order queue, like dmemhelloworld.
+    // The task graph uses two out-of-order copy queues plus one or more
+    // out-of-order compute queues.
+    chrometrace::Tracer tracer{ traceFile };
+    queue sq{ c, d, chrometrace::queue_properties(tracer) };
+    chrometrace::Queue inOrderQueue{ sq, tracer, "In-Order Queue" };
+    std::vector<queue> queues;
+    for (int q = 0; q < 2 + computeQueueCount; q++) {
+        queues.push_back(queue{ c, d, property::queue::enable_profiling() });
+    }
+    std::vector<chrometrace::Queue> copyQueues;
+    std::vector<chrometrace::Queue> computeQueues;
+    for (int q = 0; q < 2; q++) {
+        copyQueues.emplace_back(queues[q], tracer, "Copy Queue " + std::to_string(q));
+    }
+    for (int q = 0; q < computeQueueCount; q++) {
+        computeQueues.emplace_back(queues[2 + q], tracer, "Compute Queue " + std::to_string(q));
+    }
+
+    const size_t chunkSize = gwx / chunks;
+
+    auto h_src = (uint32_t*)malloc_host(gwx * sizeof(uint32_t), c);
+    auto h_dst = (uint32_t*)malloc_host(gwx * sizeof(uint32_t), c);
+    auto d_src = (uint32_t*)malloc_device(gwx * sizeof(uint32_t), d, c);
+    auto d_dst = (uint32_t*)malloc_device(gwx * sizeof(uint32_t), d, c);
+
+    unsigned int    mismatches = 0;
+
+    if (h_src && h_dst && d_src && d_dst) {
+        // init
+
+        for( size_t i = 0; i < gwx; i++ ) {
+            h_src[i] = (uint32_t)i;
+        }
+
+        auto check = [&]() {
+            for( size_t i = 0; i < gwx; i++ ) {
+                uint32_t want = compute((uint32_t)i, work);
+                if( h_dst[i] != want ) {
+                    if( mismatches < 16 ) {
+                        std::cerr << "MisMatch!  dst[" << i << "] == "
+                            << h_dst[i] << ", want "
+                            << want << "\n";
+                    }
+                    mismatches++;
+                }
+            }
+            memset(h_dst, 0, gwx * sizeof(uint32_t));
+        };
+
+        // warm up, so kernel compilation is not measured
+
+        inOrderQueue.label("warm up").parallel_for(range<1>{gwx}, [=](id<1> id) {
+            d_dst[id] = compute(d_src[id], work);
+        }).wait();
+
+        // serial: upload -> compute -> download for each chunk in order
+
+        auto start = test_clock::now();
+        for (int k = 0; k < chunks; k++) {
+            const size_t offset = k * chunkSize;
+            const std::string suffix = " " + std::to_string(k);
+            inOrderQueue.label("upload" + suffix).memcpy(d_src + offset, h_src + offset, chunkSize * sizeof(uint32_t));
+            inOrderQueue.label("compute" + suffix).parallel_for(range<1>{chunkSize}, [=](id<1> id) {
+                d_dst[offset + id] = compute(d_src[offset + id], work);
+            });
+            inOrderQueue.label("download" + suffix).memcpy(h_dst + offset, d_dst + offset, chunkSize * sizeof(uint32_t));
+        }
+        inOrderQueue.wait();
+        std::chrono::duration<float> serial_seconds = test_clock::now() - start;
+        check();
+
+        // task graph: each chunk only depends on its own previous step, so
+        // chunks may overlap across queues
+
+        TaskGraph graph;
+        for (int k = 0; k < chunks; k++) {
+            const size_t offset = k * chunkSize;
+            const std::string suffix = " " + std::to_string(k);
+            auto up = graph.addCopy("upload" + suffix,
+                d_src + offset, h_src + offset, chunkSize * sizeof(uint32_t));
+            auto kernel = graph.addKernel("compute" + suffix, [=](handler& cgh) {
+                cgh.parallel_for(range<1>{chunkSize}, [=](id<1> id) {
+                    d_dst[offset + id] = compute(d_src[offset + id], work);
+                });
+            }, { up });
+            graph.addCopy("download" + suffix,
+                h_dst + offset, d_dst + offset, chunkSize * sizeof(uint32_t), { kernel });
+        }
+
+        start = test_clock::now();
+        graph.execute(copyQueues, computeQueues);
+        graph.wait();
+        std::chrono::duration<float> graph_seconds = test_clock::now() - start;
+        check();
+
+        std::cout << "Serial in-order queue finished in " << serial_seconds.count() << " seconds\n";
+        std::cout << "Task graph across " << copyQueues.size() + computeQueues.size()
+            << " queues finished in " << graph_seconds.count() << " seconds ("
+            << serial_seconds.count() / graph_seconds.count() << "x)\n";
+
+        std::cout << "Task graph timeline:\n";
+        graph.dumpTimeline(std::cout);
+
+        if( mismatches ) {
+            std::cerr << "Error: Found "
+                << mismatches << " mismatches / " << gwx * 2 << " values!!!\n";
+        }
+        else {
+            std::cout << "Success.\n";
+        }
+    }
+
+    if (!tracer.write()) {
+        std::cerr << "Error: Couldn't write trace file " << traceFile << "!\n";
+    }
+
+    // clean up
+    free(h_src, c);
+    free(h_dst, c);
+    free(d_src, c);
+    free(d_dst, c);
+
+    return mismatches ? -1 : 0;
+}
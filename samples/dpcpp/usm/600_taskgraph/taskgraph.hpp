@@ -0,0 +1,120 @@
+/*
+// Copyright (c) 2026 Ben Ashbaugh
+//
+// SPDX-License-Identifier: MIT
+*/
+
+#pragma once
+#include <sycl/sycl.hpp>
+#include <algorithm>
+#include <cstdio>
+#include <functional>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "chrometrace/chrometrace.hpp"
+
+// A minimal task graph of copy and compute nodes with explicit
+// dependencies.  Nodes must be added after the nodes they depend on, so the
+// order nodes are added is a valid execution order.
+//
+// When the graph is executed, copy nodes are scheduled round-robin across
+// the copy queues and compute nodes round-robin across the compute queues,
+// and each node waits only for the events of its dependencies.  With
+// out-of-order queues, independent copies and kernels may overlap.  Each
+// node is labeled with its name, so the queues may also be traced.
+class TaskGraph {
+public:
+    using Node = size_t;
+
+    Node addCopy(const std::string& name, void* dst, const void* src, size_t bytes,
+        const std::vector<Node>& deps = {}) {
+        return addNode(name, true, [=](sycl::handler& cgh) {
+            cgh.memcpy(dst, src, bytes);
+        }, deps);
+    }
+
+    Node addKernel(const std::string& name, std::function<void(sycl::handler&)> cgf,
+        const std::vector<Node>& deps = {}) {
+        return addNode(name, false, std::move(cgf), deps);
+    }
+
+    void execute(std::vector<chrometrace::Queue>& copyQueues, std::vector<chrometrace::Queue>& computeQueues) {
+        size_t nextCopy = 0;
+        size_t nextCompute = 0;
+        for (auto& node : nodes) {
+            std::vector<sycl::event> depEvents;
+            for (auto d : node.deps) {
+                depEvents.push_back(nodes[d].event);
+            }
+
+            auto& queues = node.copy ? copyQueues : computeQueues;
+            auto& next = node.copy ? nextCopy : nextCompute;
+            node.queue = next++ % queues.size();
+            node.event = queues[node.queue].label(node.name).submit([&](sycl::handler& cgh) {
+                cgh.depends_on(depEvents);
+                node.cgf(cgh);
+            });
+        }
+    }
+
+    void wait() {
+        for (auto& node : nodes) {
+            node.event.wait();
+        }
+    }
+
+    // Prints the start and end time of each node relative to the start of
+    // the first node, with a bar showing when it executed.  The queues must
+    // have been created with the enable_profiling property.
+    void dumpTimeline(std::ostream& os, int columns = 60) const {
+        if (nodes.empty()) {
+            return;
+        }
+
+        std::vector<uint64_t> starts, ends;
+        for (auto& node : nodes) {
+            starts.push_back(node.event.get_profiling_info<sycl::info::event_profiling::command_start>());
+            ends.push_back(node.event.get_profiling_info<sycl::info::event_profiling::command_end>());
+        }
+        const uint64_t first = *std::min_element(starts.begin(), starts.end());
+        const uint64_t last = *std::max_element(ends.begin(), ends.end());
+        const double scale = columns / (double)std::max<uint64_t>(last - first, 1);
+
+        for (size_t n = 0; n < nodes.size(); n++) {
+            const int begin = (int)((starts[n] - first) * scale);
+            const int end = std::max(begin + 1, (int)((ends[n] - first) * scale));
+            std::string bar(columns + 1, ' ');
+            std::fill(bar.begin() + std::min(begin, columns), bar.begin() + std::min(end, columns + 1), '#');
+
+            char line[256];
+            snprintf(line, sizeof(line), "%-14s %s queue %zu %10.1f us %10.1f us |%s|\n",
+                nodes[n].name.c_str(),
+                nodes[n].copy ? "copy   " : "compute",
+                nodes[n].queue,
+                (starts[n] - first) / 1000.0,
+                (ends[n] - first) / 1000.0,
+                bar.c_str());
+            os << line;
+        }
+    }
+
+private:
+    struct NodeInfo {
+        std::string name;
+        bool copy;
+        std::function<void(sycl::handler&)> cgf;
+        std::vector<Node> deps;
+        size_t queue = 0;
+        sycl::event event;
+    };
+
+    Node addNode(const std::string& name, bool copy, std::function<void(sycl::handler&)> cgf,
+        const std::vector<Node>& deps) {
+        nodes.push_back(NodeInfo{ name, copy, std::move(cgf), deps });
+        return nodes.size() - 1;
+    }
+
+    std::vector<NodeInfo> nodes;
+};